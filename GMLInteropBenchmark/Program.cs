@@ -0,0 +1,142 @@
+﻿using SubModLoader.GMLInterop;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Text;
+
+namespace GMLInteropBenchmark {
+    internal static class Program {
+        private const string Usage = """
+            Times GMLInteropReader.ReadString against decoding every string with Encoding.UTF8, for short, medium and large strings.
+
+            Usage: GMLInteropBenchmark [--time <milliseconds per case>]
+
+            Repeated reads the same string every time, like the class and method names of a call. Unique reads a different string every time, so the cache never hits.
+            Large strings are longer than the cache keeps, so they are always decoded.
+            Build in Release, a Debug build mostly measures itself.
+            """;
+
+        private sealed record Size(string Name, int Length);
+
+        private static readonly Size[] Sizes = {
+            new("Short", 16),
+            new("Medium", 96),
+            new("Large", 1024)
+        };
+
+        // More than the cache has slots, so unique strings keep replacing each other
+        private const int UniqueCount = 4096;
+        private const int RepeatedCount = 4096;
+        private const double WarmUpMilliseconds = 200;
+
+        // Tiered compilation waits for jitting to settle before it replaces the precompiled framework code, like HashCode.AddBytes, with optimized code.
+        // That can take seconds and skew the first cases, and the runtime only reads this at startup, so the benchmark starts itself again with it set.
+        private const string CallCountingDelayVariable = "DOTNET_TC_CallCountingDelayMs";
+
+        private static int Main(string[] args) {
+            if (Environment.GetEnvironmentVariable(CallCountingDelayVariable) is null)
+                return RunAgainWithoutCallCountingDelay(args);
+
+            double milliseconds = 500;
+
+            for (int i = 0; i < args.Length; i++) {
+                if (args[i] is "-h" or "--help") {
+                    Console.WriteLine(Usage);
+                    return 0;
+                } else if (args[i] is "-t" or "--time") {
+                    if (i + 1 >= args.Length || !double.TryParse(args[++i], out milliseconds) || milliseconds <= 0) {
+                        Console.Error.WriteLine(Usage);
+                        return 1;
+                    }
+                } else {
+                    Console.Error.WriteLine(Usage);
+                    return 1;
+                }
+            }
+
+            Console.WriteLine($"{"Case",-24} {"ReadString (ns)",16} {"Alloc (B)",10} {"UTF8 (ns)",12} {"Alloc (B)",10}");
+            foreach (Size size in Sizes) {
+                Run($"{size.Name} repeated", Enumerable.Repeat(MakeString(size.Length, 0), RepeatedCount).ToList(), milliseconds);
+                Run($"{size.Name} unique", Enumerable.Range(0, UniqueCount).Select(i => MakeString(size.Length, i)).ToList(), milliseconds);
+            }
+
+            return 0;
+        }
+
+        private static int RunAgainWithoutCallCountingDelay(string[] args) {
+            string processPath = Environment.ProcessPath;
+            ProcessStartInfo startInfo = new(processPath);
+            // Started with "dotnet GMLInteropBenchmark.dll" rather than the apphost
+            if (Path.GetFileNameWithoutExtension(processPath) == "dotnet")
+                startInfo.ArgumentList.Add(typeof(Program).Assembly.Location);
+            foreach (string arg in args)
+                startInfo.ArgumentList.Add(arg);
+            startInfo.Environment[CallCountingDelayVariable] = "0";
+
+            using Process process = Process.Start(startInfo);
+            process.WaitForExit();
+            return process.ExitCode;
+        }
+
+        // Ends in the index so strings of the same length differ
+        private static string MakeString(int length, int index) {
+            string suffix = $".{index}";
+            return $"{new string('a', length - suffix.Length)}{suffix}";
+        }
+
+        private static unsafe void Run(string name, List<string> strings, double milliseconds) {
+            // Laid out the way gml writes them, a uint of the buffer length then null terminated strings
+            List<byte> bytes = new(BitConverter.GetBytes(0u));
+            foreach (string value in strings) {
+                bytes.AddRange(Encoding.UTF8.GetBytes(value));
+                bytes.Add(0);
+            }
+            byte[] buffer = bytes.ToArray();
+            BitConverter.TryWriteBytes(buffer, (uint)buffer.Length);
+
+            fixed (byte* start = buffer) {
+                byte* bufferStart = start;
+                GMLInteropReader reader = new(bufferStart);
+
+                (double readNanoseconds, double readBytes) = Measure(milliseconds, strings.Count, () => {
+                    reader.Reset(bufferStart);
+                    for (int i = 0; i < strings.Count; i++)
+                        reader.ReadString();
+                });
+                (double utf8Nanoseconds, double utf8Bytes) = Measure(milliseconds, strings.Count, () => {
+                    int offset = sizeof(uint);
+                    for (int i = 0; i < strings.Count; i++) {
+                        int length = new ReadOnlySpan<byte>(bufferStart + offset, buffer.Length - offset).IndexOf((byte)0);
+                        Encoding.UTF8.GetString(bufferStart + offset, length);
+                        offset += length + 1;
+                    }
+                });
+
+                Console.WriteLine($"{name,-24} {readNanoseconds,16:F1} {readBytes,10:F0} {utf8Nanoseconds,12:F1} {utf8Bytes,10:F0}");
+            }
+        }
+
+        // Returns the time and allocated bytes of a single read
+        private static (double nanoseconds, double allocatedBytes) Measure(double milliseconds, int readsPerPass, Action pass) {
+            // Long enough for tiered compilation to have optimized everything that's timed
+            Stopwatch time = Stopwatch.StartNew();
+            while (time.Elapsed.TotalMilliseconds < WarmUpMilliseconds)
+                pass();
+
+            long passes = 0;
+            long allocatedBefore = GC.GetAllocatedBytesForCurrentThread();
+            time.Restart();
+            while (time.Elapsed.TotalMilliseconds < milliseconds) {
+                pass();
+                passes++;
+            }
+            time.Stop();
+            long allocated = GC.GetAllocatedBytesForCurrentThread() - allocatedBefore;
+
+            double reads = (double)passes * readsPerPass;
+            return (time.Elapsed.TotalMilliseconds * 1_000_000 / reads, allocated / reads);
+        }
+    }
+}
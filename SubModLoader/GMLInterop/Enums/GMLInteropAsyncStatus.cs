@@ -0,0 +1,23 @@
+﻿namespace SubModLoader.GMLInterop.Enums {
+    /// <summary>
+    /// The state of a call started with <see cref="Mods.SubMod.CallFromGMLAsync{T}"/>, as returned to gml
+    /// </summary>
+    public enum GMLInteropAsyncStatus {
+        /// <summary>
+        /// The handle was never returned, or has already been collected or cancelled
+        /// </summary>
+        Invalid = -1,
+        /// <summary>
+        /// Still running, or finished but not yet handed to gml because of the per-frame completion budget
+        /// </summary>
+        Pending = 0,
+        /// <summary>
+        /// Finished, the result can be collected
+        /// </summary>
+        Completed,
+        /// <summary>
+        /// Threw an exception, which was logged
+        /// </summary>
+        Failed
+    }
+}
@@ -0,0 +1,15 @@
+﻿namespace SubModLoader.GMLInterop.Enums {
+    /// <summary>
+    /// Which side fills a <see cref="GMLSharedRegion{T}"/>, the other side only reads it
+    /// </summary>
+    public enum GMLSharedRegionWriter {
+        /// <summary>
+        /// Gml sets elements and publishes them, C# reads them
+        /// </summary>
+        GML,
+        /// <summary>
+        /// C# writes elements and publishes them, gml reads them
+        /// </summary>
+        CSharp
+    }
+}
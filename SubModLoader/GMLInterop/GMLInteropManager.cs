@@ -3,11 +3,18 @@ using SubmachineModLib.Models;
 using SubModLoader.GameData.Extensions;
 using SubModLoader.GMLInterop.Enums;
 using SubModLoader.Mods;
+using SubModLoader.Storage;
+using SubModLoader.Storage.Widget;
+using SubModLoader.Storage.Widget.Item;
 using SubModLoader.Utils;
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Reflection;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
 
 namespace SubModLoader.GMLInterop {
     /// <summary>
@@ -48,6 +55,9 @@ namespace SubModLoader.GMLInterop {
             /// The function, in gml, that read this registered type from a buffer
             /// </summary>
             public GameMakerFunction GMLRead { get; }
+
+            // Whether the type or its read and write functions come from the assembly
+            internal bool IsOwnedBy(Assembly assembly);
         }
 
         /// <summary>
@@ -77,6 +87,12 @@ namespace SubModLoader.GMLInterop {
             /// <inheritdoc/>
             public GameMakerFunction GMLRead => _gmlRead;
 
+            bool IRegisteredType.IsOwnedBy(Assembly assembly) =>
+                IsTypeFrom(_type, assembly) || _write.Method.Module.Assembly == assembly || _read.Method.Module.Assembly == assembly;
+
+            private static bool IsTypeFrom(Type type, Assembly assembly) =>
+                type.Assembly == assembly || (type.HasElementType && IsTypeFrom(type.GetElementType(), assembly)) || type.GenericTypeArguments.Any(arg => IsTypeFrom(arg, assembly));
+
             internal RegisteredType(GameMakerData gameData, GMLInteropTypeId id, Action<GMLInteropWriter, T> write, Func<GMLInteropReader, T> read, string gmlWrite, string gmlRead) {
                 _id = id;
                 _type = typeof(T);
@@ -111,6 +127,12 @@ namespace SubModLoader.GMLInterop {
         internal static void Initialize(GameMakerData gameData) {
             bool x64 = IntPtr.Size == 8;
 
+            // Starts over when a rebuild of only the C# side didn't match the prebuilt modded.win
+            NextTypeId = GMLInteropTypeId.RegisteredTypesStart;
+            foreach (GMLSharedRegion region in SharedRegions.Values)
+                MemoryTracker.SharedRegions.Remove(2L * region.Capacity * region.ElementSize);
+            SharedRegions.Clear();
+
             RegisteredTypesByType = new() {
                 [typeof(void)] = new RegisteredType<object>(gameData, GMLInteropTypeId.Void, (_, _) => { }, _ => null, "", ""),
                 [typeof(byte)] = new RegisteredType<byte>(gameData, GMLInteropTypeId.Byte,
@@ -248,6 +270,29 @@ namespace SubModLoader.GMLInterop {
                 """);
 
             Add_call_csharp(gameData);
+            Add_call_csharp_async(gameData);
+        }
+
+        // There's no game data while only the C# side is rebuilt for a prebuilt modded.win
+        private static void ThrowIfNoGameData(GameMakerData gameData) {
+            if (!Modding.IsRebuildingRegistry)
+                ArgumentNullException.ThrowIfNull(gameData, nameof(gameData));
+        }
+
+        // The registered types keep the assembly's Types and delegates, so a mod that owns any can't be swapped by a hot reload
+        internal static List<Type> GetRegisteredTypesOwnedBy(Assembly assembly) =>
+            RegisteredTypesById.Values.Where(register => register.IsOwnedBy(assembly)).OrderBy(register => register.Id).Select(register => register.Type).ToList();
+
+        // Everything the gml in modded.win needs C# to agree on, so a rebuild of only the C# side can be checked against it
+        internal static string DescribeRegistry() {
+            StringBuilder registry = new();
+
+            foreach (IRegisteredType register in RegisteredTypesById.Values.OrderBy(register => register.Id))
+                registry.AppendLine($"Type {register.Id.ToValue()} {register.Type.FullName}");
+            foreach (GMLSharedRegion region in SharedRegions.Values.OrderBy(region => region.Name, StringComparer.Ordinal))
+                registry.AppendLine($"Region {region.Name} {region.Capacity} {region.ElementSize} {region.Writer} {string.Join(" ", region.Fields.Select(field => $"{field.Name}:{field.Offset}:{field.Type}"))}");
+
+            return registry.ToString();
         }
 
         /// <summary>
@@ -310,7 +355,7 @@ namespace SubModLoader.GMLInterop {
         /// <exception cref="ArgumentNullException"></exception>
         /// <exception cref="InvalidOperationException"></exception>
         public static GMLInteropTypeId RegisterType<T>(GameMakerData gameData, Action<GMLInteropWriter, T> write, Func<GMLInteropReader, T> read, string gmlWrite, string gmlRead) {
-            ArgumentNullException.ThrowIfNull(gameData, nameof(gameData));
+            ThrowIfNoGameData(gameData);
             ArgumentNullException.ThrowIfNull(write, nameof(write));
             ArgumentNullException.ThrowIfNull(read, nameof(read));
             ArgumentNullException.ThrowIfNull(gmlWrite, nameof(gmlWrite));
@@ -339,7 +384,7 @@ namespace SubModLoader.GMLInterop {
         /// <typeparam name="T">The type to override</typeparam>
         /// <inheritdoc cref="RegisterType{T}"/>
         public static GMLInteropTypeId OverrideRegisteredType<T>(GameMakerData gameData, Action<GMLInteropWriter, T> write, Func<GMLInteropReader, T> read, string gmlWrite, string gmlRead) {
-            ArgumentNullException.ThrowIfNull(gameData, nameof(gameData));
+            ThrowIfNoGameData(gameData);
             ArgumentNullException.ThrowIfNull(write, nameof(write));
             ArgumentNullException.ThrowIfNull(read, nameof(read));
             ArgumentNullException.ThrowIfNull(gmlWrite, nameof(gmlWrite));
@@ -362,43 +407,124 @@ namespace SubModLoader.GMLInterop {
             return RegisterType(gameData, write, read, gmlWrite, gmlRead);
         }
 
+        #region Shared Regions
+
+        // Only the untyped regions are kept so a hot reloaded mod's element type doesn't keep the old version alive
+        private static Dictionary<string, GMLSharedRegion> SharedRegions { get; } = new();
+
+        /// <summary>
+        /// Registers a region of memory shared between gml and C#, for data sent every frame without going through <see cref="CallFromGML{T}(T, string[])"/>
+        /// </summary>
+        /// <typeparam name="T">The element type, a struct made only of types gml buffers support, such as <see cref="int"/>, <see cref="float"/> and <see cref="bool"/></typeparam>
+        /// <param name="gameData">The game data</param>
+        /// <param name="name">The name of the region, must be usable in a gml function name</param>
+        /// <param name="capacity">The max number of elements</param>
+        /// <param name="writer">Which side fills the region</param>
+        /// <returns>The region</returns>
+        /// <exception cref="ArgumentNullException"></exception>
+        /// <exception cref="ArgumentException"></exception>
+        /// <exception cref="ArgumentOutOfRangeException"></exception>
+        /// <exception cref="InvalidOperationException"></exception>
+        public static unsafe GMLSharedRegion<T> RegisterSharedRegion<T>(GameMakerData gameData, string name, int capacity, GMLSharedRegionWriter writer) where T : unmanaged {
+            ThrowIfNoGameData(gameData);
+            ArgumentNullException.ThrowIfNull(name, nameof(name));
+            if (capacity <= 0)
+                throw new ArgumentOutOfRangeException(nameof(capacity), capacity, "A shared region needs room for at least one element.");
+            if (name.Length == 0 || !name.All(c => char.IsAsciiLetterOrDigit(c) || c == '_'))
+                throw new ArgumentException($"Shared region name \"{name}\" can only contain letters, digits and underscores.", nameof(name));
+
+            if (Modding.HasAppliedMods)
+                throw new InvalidOperationException("Can't register new shared regions after mods have been applied.");
+            if (SharedRegions.ContainsKey(name))
+                throw new InvalidOperationException($"Can't register shared region {name} twice.");
+
+            GMLSharedRegion region = new(gameData, name, capacity, writer, typeof(T), sizeof(T));
+            SharedRegions[name] = region;
+            MemoryTracker.SharedRegions.Add(2L * capacity * sizeof(T));
+            return new(region);
+        }
+
+        /// <summary>
+        /// Gets a region registered with <see cref="RegisterSharedRegion{T}"/>, such as after a mod has been hot reloaded
+        /// </summary>
+        /// <typeparam name="T">The element type, must be the same size as the one it was registered with</typeparam>
+        /// <param name="name">The name of the region</param>
+        /// <returns>The region</returns>
+        /// <exception cref="ArgumentException"></exception>
+        public static unsafe GMLSharedRegion<T> GetSharedRegion<T>(string name) where T : unmanaged {
+            if (!SharedRegions.TryGetValue(name, out GMLSharedRegion region))
+                throw new ArgumentException($"Shared region {name} has not been registered.", nameof(name));
+            if (region.ElementSize != sizeof(T))
+                throw new ArgumentException($"Shared region {name} has {region.ElementSize} byte elements, {typeof(T)} is {sizeof(T)} bytes.", nameof(T));
+            return new(region);
+        }
+
+        #endregion
+
         private const string GML_call_csharp = "submodloader_call_csharp";
 
         #region Call C#
 
+        // Fills metadataBuffer and argBuffer from the arguments of submodloader_call_csharp and submodloader_call_csharp_async
+        private static string WriteCallBuffersGML() => $$"""
+            var metadataBuffer = buffer_create(256, buffer_grow, 1) // 256 is a good starting length with strings imo
+            buffer_seek(metadataBuffer, buffer_seek_start, 4)
+
+            var classType = argument[0];
+            buffer_write(metadataBuffer, buffer_string, classType)
+            var classMethod = argument[1];
+            buffer_write(metadataBuffer, buffer_string, classMethod)
+
+            var returnType = argument[2]
+            buffer_write(metadataBuffer, buffer_u32, returnType)
+            var argCount = argument[3]
+            buffer_write(metadataBuffer, buffer_u32, argCount)
+
+            buffer_seek(metadataBuffer, buffer_seek_start, 0)
+            buffer_write(metadataBuffer, buffer_u32, buffer_get_size(metadataBuffer))
+            
+            var argBuffer = buffer_create(5 * argCount + 4, buffer_grow, 1) // assume each arg is 1 byte + 4 byte type, then add 4 byte size, and grow from there
+            buffer_seek(argBuffer, buffer_seek_start, 4)
+
+            for (var i = 4; i < argument_count; i += 2) {
+                {{GMLInteropWriter.WriteInteropTypeIdFromGML("argument[i]")}}
+                var prevSeek = buffer_tell(argBuffer)
+                {{GMLInteropWriter.WriteFromGML("argument[i]", "argument[i + 1]")}}
+                var newSeek = buffer_tell(argBuffer)
+                if (newSeek < prevSeek)
+                    buffer_seek(argBuffer, buffer_seek_start, prevSeek)
+            }
+            
+            buffer_seek(argBuffer, buffer_seek_start, 0)
+            buffer_write(argBuffer, buffer_u32, buffer_get_size(argBuffer))
+            """;
+
+        // Reads the result that resultPtrBuffer points to into result, then deletes it
+        private static string ReadResultGML() => $$"""
+            if (!variable_global_exists("submodloader_delete_result_extern"))
+                global.submodloader_delete_result_extern = external_define("SubModLoaderNative.dll", "DeleteResult", dll_cdecl, ty_real, 1, ty_string)
+            if (!variable_global_exists("submodloader_get_result_size_extern"))
+                global.submodloader_get_result_size_extern = external_define("SubModLoaderNative.dll", "GetResultSize", dll_cdecl, ty_real, 1, ty_string)
+            if (!variable_global_exists("submodloader_copy_result_to_buffer_extern"))
+                global.submodloader_copy_result_to_buffer_extern = external_define("SubModLoaderNative.dll", "CopyResultToBuffer", dll_cdecl, ty_real, 2, ty_string, ty_string)
+
+            var resultSize = external_call(global.submodloader_get_result_size_extern, buffer_get_address(resultPtrBuffer))
+            if (resultSize > 0) { // 0 when the call threw
+                var resultBuffer = buffer_create(resultSize, buffer_fixed, 1)
+                external_call(global.submodloader_copy_result_to_buffer_extern, buffer_get_address(resultBuffer), buffer_get_address(resultPtrBuffer))
+                buffer_seek(resultBuffer, buffer_seek_start, 4)
+
+                result = {{GMLInteropReader.ReadFromGML("returnType")}}
+
+                buffer_delete(resultBuffer)
+                external_call(global.submodloader_delete_result_extern, buffer_get_address(resultPtrBuffer))
+            }
+            """;
+
         // TODO: allow ref and out params
         internal static void Add_call_csharp(GameMakerData gameData) {
             gameData.AddCodeAndFunction(GML_call_csharp, $$"""
-                var metadataBuffer = buffer_create(256, buffer_grow, 1) // 256 is a good starting length with strings imo
-                buffer_seek(metadataBuffer, buffer_seek_start, 4)
-
-                var classType = argument[0];
-                buffer_write(metadataBuffer, buffer_string, classType)
-                var classMethod = argument[1];
-                buffer_write(metadataBuffer, buffer_string, classMethod)
-
-                var returnType = argument[2]
-                buffer_write(metadataBuffer, buffer_u32, returnType)
-                var argCount = argument[3]
-                buffer_write(metadataBuffer, buffer_u32, argCount)
-
-                buffer_seek(metadataBuffer, buffer_seek_start, 0)
-                buffer_write(metadataBuffer, buffer_u32, buffer_get_size(metadataBuffer))
-                
-                var argBuffer = buffer_create(5 * argCount + 4, buffer_grow, 1) // assume each arg is 1 byte + 4 byte type, then add 4 byte size, and grow from there
-                buffer_seek(argBuffer, buffer_seek_start, 4)
-
-                for (var i = 4; i < argument_count; i += 2) {
-                    {{GMLInteropWriter.WriteInteropTypeIdFromGML("argument[i]")}}
-                    var prevSeek = buffer_tell(argBuffer)
-                    {{GMLInteropWriter.WriteFromGML("argument[i]", "argument[i + 1]")}}
-                    var newSeek = buffer_tell(argBuffer)
-                    if (newSeek < prevSeek)
-                        buffer_seek(argBuffer, buffer_seek_start, prevSeek)
-                }
-                
-                buffer_seek(argBuffer, buffer_seek_start, 0)
-                buffer_write(argBuffer, buffer_u32, buffer_get_size(argBuffer))
+                {{WriteCallBuffersGML()}}
 
                 var resultPtrBuffer = buffer_create(8, buffer_fixed, 1) // enough to fit a 64bit ptr, but still works for a 32bit ptr
 
@@ -409,23 +535,8 @@ namespace SubModLoader.GMLInterop {
                 var result = 0
                 var hasResult = false
                 if (returnType != {{GMLInteropTypeId.Void.ToValue()}}) {
-                    if (!variable_global_exists("submodloader_delete_result_extern"))
-                        global.submodloader_delete_result_extern = external_define("SubModLoaderNative.dll", "DeleteResult", dll_cdecl, ty_real, 1, ty_string)
-                    if (!variable_global_exists("submodloader_get_result_size_extern"))
-                        global.submodloader_get_result_size_extern = external_define("SubModLoaderNative.dll", "GetResultSize", dll_cdecl, ty_real, 1, ty_string)
-                    if (!variable_global_exists("submodloader_copy_result_to_buffer_extern"))
-                        global.submodloader_copy_result_to_buffer_extern = external_define("SubModLoaderNative.dll", "CopyResultToBuffer", dll_cdecl, ty_real, 2, ty_string, ty_string)
-
-                    var resultSize = external_call(global.submodloader_get_result_size_extern, buffer_get_address(resultPtrBuffer))
-                    var resultBuffer = buffer_create(resultSize, buffer_fixed, 1)
-                    external_call(global.submodloader_copy_result_to_buffer_extern, buffer_get_address(resultBuffer), buffer_get_address(resultPtrBuffer))
-                    buffer_seek(resultBuffer, buffer_seek_start, 4)
-
-                    result = {{GMLInteropReader.ReadFromGML("returnType")}}
+                    {{ReadResultGML()}}
                     hasResult = true
-
-                    buffer_delete(resultBuffer)
-                    external_call(global.submodloader_delete_result_extern, buffer_get_address(resultPtrBuffer))
                 }
 
                 buffer_delete(metadataBuffer)
@@ -439,48 +550,78 @@ namespace SubModLoader.GMLInterop {
 
         private unsafe delegate void CallCSharpDelegate(byte* metadata, byte* argData, byte** resultData);
         internal static unsafe void CallCSharp(byte* metadata, byte* argData, byte** resultData) {
-            try {
-                GMLInteropReader reader = new(metadata);
-
-                string classTypeName = reader.ReadString();
-                string classMethodName = reader.ReadString();
-                GMLInteropTypeId returnType = reader.ReadInteropTypeId();
-                uint argCount = reader.ReadUInt();
-
-                reader.Reset(argData);
-                object[] args = new object[argCount];
-                Type[] types = new Type[argCount];
-                for (int i = 0; i < argCount; i++) {
-                    GMLInteropTypeId type = reader.ReadInteropTypeId();
-                    args[i] = reader.Read(type);
-                    types[i] = type.ToType();
-                }
+            // Gml reads whatever is left here, so it can't be garbage when the call throws
+            *resultData = null;
+            long gmlBytes = GetCallBuffersSize(metadata, argData);
+            MemoryTracker.GMLCallBuffers.Add(gmlBytes);
 
-                MethodInfo method = Type.GetType(classTypeName).GetMethod(classMethodName, BindingFlags.Static | BindingFlags.Public | BindingFlags.NonPublic, types) ?? throw new MissingMethodException(classTypeName, classMethodName);
+            try {
+                (DispatchTarget target, object[] args, GMLInteropTypeId returnType) = ReadCall(metadata, argData, false);
 
                 if (returnType == GMLInteropTypeId.Void)
-                    method.Invoke(null, args);
+                    target.Method.Invoke(null, args);
                 else {
-                    object result = method.Invoke(null, args);
+                    object result = target.Method.Invoke(null, args);
                     GMLInteropWriter writer = new();
                     writer.Write(returnType, result);
-                    *resultData = writer.GetBytes();
+                    *resultData = writer.GetBytes(target.ResultOwner);
                 }
             } catch (Exception e) {
                 Logger.WriteError(e);
+            } finally {
+                MemoryTracker.GMLCallBuffers.Remove(gmlBytes);
+            }
+        }
+
+        // Both start with their size, and gml deletes them as soon as the call returns
+        private static unsafe long GetCallBuffersSize(byte* metadata, byte* argData) => *(uint*)metadata + *(uint*)argData;
+
+        // Reads the call out of the gml buffers, which are deleted as soon as the call returns
+        private static unsafe (DispatchTarget target, object[] args, GMLInteropTypeId returnType) ReadCall(byte* metadata, byte* argData, bool allowCancellation) {
+            GMLInteropReader reader = new(metadata);
+
+            string classTypeName = reader.ReadString();
+            string classMethodName = reader.ReadString();
+            GMLInteropTypeId returnType = reader.ReadInteropTypeId();
+            uint argCount = reader.ReadUInt();
+
+            reader.Reset(argData);
+            object[] args = new object[argCount];
+            Type[] types = new Type[argCount];
+            for (int i = 0; i < argCount; i++) {
+                GMLInteropTypeId type = reader.ReadInteropTypeId();
+                args[i] = reader.Read(type);
+                types[i] = type.ToType();
             }
+
+            // Async targets can take a trailing CancellationToken that gml doesn't pass
+            if (allowCancellation) {
+                DispatchTarget cancellable = FindDispatchTarget(classTypeName, classMethodName, types.Append(typeof(CancellationToken)).ToArray());
+                if (cancellable is not null)
+                    return (cancellable, args.Append(null).ToArray(), returnType);
+            }
+
+            return (GetDispatchTarget(classTypeName, classMethodName, types), args, returnType);
         }
 
         internal static string CallFromGML<T>(T function, params string[] gmlVarsOrExpressions) where T : Delegate {
             MethodInfo method = function.Method;
+            return CallFromGML(GML_call_csharp, method, method.GetParameters(), method.ReturnType, gmlVarsOrExpressions);
+        }
+
+        private static string CallFromGML(string gmlFunction, MethodInfo method, ParameterInfo[] parameters, Type returnType, string[] gmlVarsOrExpressions) {
             if (!method.IsStatic)
-                throw new ArgumentException("The function must be a static method since no instance information can be provided from gml.", nameof(function));
+                throw new ArgumentException("The function must be a static method since no instance information can be provided from gml.", nameof(method));
+
+            string assemblyName = method.DeclaringType.Assembly.GetName().Name;
+            if (!CallTargetsByAssembly.TryGetValue(assemblyName, out HashSet<string> callTargets))
+                CallTargetsByAssembly[assemblyName] = callTargets = new();
+            callTargets.Add(GetCallTargetKey(method));
 
-            ParameterInfo[] parameters = method.GetParameters();
             if (gmlVarsOrExpressions.Length < parameters.Length)
                 throw new ArgumentException("Optional parameters are not currently supported, you must supply a gml variable or expression for each parameter. Create a wrapper method if you need optional parameters.", nameof(gmlVarsOrExpressions));
 
-            string resultGML = $"{GML_call_csharp}(\"{method.DeclaringType.AssemblyQualifiedName}\", \"{method.Name}\", {method.ReturnType.ToGMLInteropTypeId().ToValue()}, {parameters.Length}";
+            string resultGML = $"{gmlFunction}(\"{method.DeclaringType.AssemblyQualifiedName}\", \"{method.Name}\", {returnType.ToGMLInteropTypeId().ToValue()}, {parameters.Length}";
 
             for (int i = 0; i < parameters.Length; i++)
                 resultGML += $", {parameters[i].ParameterType.ToGMLInteropTypeId().ToValue()}, {gmlVarsOrExpressions[i]}";
@@ -491,5 +632,283 @@ namespace SubModLoader.GMLInterop {
         }
 
         #endregion
+
+        #region Call C# Async
+
+        private const string GML_call_csharp_async = "submodloader_call_csharp_async";
+        private const string GML_async_status = "submodloader_async_status";
+        private const string GML_async_result = "submodloader_async_result";
+        private const string GML_async_cancel = "submodloader_async_cancel";
+
+        private static SettingsCategory InteropCategory { get; } = Settings.SubModLoaderSettings.GetCategory("Interop", false);
+        private static SettingsInteger<int> AsyncWorkerCount { get; } = SettingsInteger<int>.Get(InteropCategory, "AsyncWorkerCount", Math.Max(1, Environment.ProcessorCount / 2));
+        // Results handed back to gml per frame, so a burst of finished calls doesn't all land on the same frame
+        private static SettingsInteger<int> AsyncCompletionsPerFrame { get; } = SettingsInteger<int>.Get(InteropCategory, "AsyncCompletionsPerFrame", 32);
+
+        private sealed class AsyncCall {
+            public long Handle { get; init; }
+            public GMLInteropTypeId ReturnType { get; init; }
+            public string Owner { get; init; }
+            public CancellationTokenSource Cancellation { get; } = new();
+            // Only changed on the game thread, so gml never sees more than the budget finish in a frame
+            public GMLInteropAsyncStatus Status { get; set; } = GMLInteropAsyncStatus.Pending;
+            // Cancelled by gml, which frees its handle straight away, so it's deleted once it finishes without logging the cancellation
+            public bool IsAbandoned { get; set; }
+            public IntPtr Result { get; set; }
+            public Exception Exception { get; set; }
+        }
+
+        private static long NextAsyncHandle = 0;
+        private static ConcurrentDictionary<long, AsyncCall> AsyncCalls { get; } = new();
+        private static ConcurrentQueue<AsyncCall> FinishedAsyncCalls { get; } = new();
+        private static Lazy<TaskScheduler> AsyncScheduler { get; } = new(() => new ConcurrentExclusiveSchedulerPair(TaskScheduler.Default, Math.Max(1, AsyncWorkerCount.Value)).ConcurrentScheduler);
+
+        internal static void Add_call_csharp_async(GameMakerData gameData) {
+            gameData.AddCodeAndFunction(GML_call_csharp_async, $$"""
+                {{WriteCallBuffersGML()}}
+
+                if (!variable_global_exists("{{GML_call_csharp_async}}_extern"))
+                    global.{{GML_call_csharp_async}}_extern = external_define("SubModLoaderNative.dll", "CallCSharpAsync", dll_cdecl, ty_real, 2, ty_string, ty_string)
+                var handle = external_call(global.{{GML_call_csharp_async}}_extern, buffer_get_address(metadataBuffer), buffer_get_address(argBuffer))
+
+                buffer_delete(metadataBuffer)
+                buffer_delete(argBuffer)
+
+                return handle
+                """);
+            gameData.AddCodeAndFunction(GML_async_status, $$"""
+                if (!variable_global_exists("{{GML_async_status}}_extern"))
+                    global.{{GML_async_status}}_extern = external_define("SubModLoaderNative.dll", "PollCSharpAsync", dll_cdecl, ty_real, 1, ty_real)
+                return external_call(global.{{GML_async_status}}_extern, argument0)
+                """);
+            gameData.AddCodeAndFunction(GML_async_result, $$"""
+                if (!variable_global_exists("{{GML_async_result}}_extern"))
+                    global.{{GML_async_result}}_extern = external_define("SubModLoaderNative.dll", "CollectCSharpAsync", dll_cdecl, ty_real, 2, ty_real, ty_string)
+
+                var resultPtrBuffer = buffer_create(8, buffer_fixed, 1) // enough to fit a 64bit ptr, but still works for a 32bit ptr
+                var returnType = external_call(global.{{GML_async_result}}_extern, argument0, buffer_get_address(resultPtrBuffer))
+
+                var result = undefined
+                if (returnType > {{GMLInteropTypeId.Void.ToValue()}}) {
+                    {{ReadResultGML()}}
+                }
+
+                buffer_delete(resultPtrBuffer)
+
+                return result
+                """);
+            gameData.AddCodeAndFunction(GML_async_cancel, $$"""
+                if (!variable_global_exists("{{GML_async_cancel}}_extern"))
+                    global.{{GML_async_cancel}}_extern = external_define("SubModLoaderNative.dll", "CancelCSharpAsync", dll_cdecl, ty_real, 1, ty_real)
+                external_call(global.{{GML_async_cancel}}_extern, argument0)
+                """);
+        }
+
+        private unsafe delegate long CallCSharpAsyncDelegate(byte* metadata, byte* argData);
+        internal static unsafe long CallCSharpAsync(byte* metadata, byte* argData) {
+            long gmlBytes = GetCallBuffersSize(metadata, argData);
+            MemoryTracker.GMLCallBuffers.Add(gmlBytes);
+
+            try {
+                (DispatchTarget target, object[] args, GMLInteropTypeId returnType) = ReadCall(metadata, argData, true);
+                MethodInfo method = target.Method;
+
+                AsyncCall call = new() { Handle = Interlocked.Increment(ref NextAsyncHandle), ReturnType = returnType, Owner = target.AsyncResultOwner };
+                if (args.Length > 0 && method.GetParameters()[^1].ParameterType == typeof(CancellationToken))
+                    args[^1] = call.Cancellation.Token;
+                AsyncCalls[call.Handle] = call;
+                MemoryTracker.AsyncCalls.Add(0);
+
+                // Not given the token, so a cancelled call still reaches FinishedAsyncCalls
+                Task.Factory.StartNew(() => RunAsyncCall(call, method, args), CancellationToken.None, TaskCreationOptions.DenyChildAttach, AsyncScheduler.Value);
+                return call.Handle;
+            } catch (Exception e) {
+                Logger.WriteError(e);
+                return 0;
+            } finally {
+                MemoryTracker.GMLCallBuffers.Remove(gmlBytes);
+            }
+        }
+
+        private static async Task RunAsyncCall(AsyncCall call, MethodInfo method, object[] args) {
+            try {
+                call.Cancellation.Token.ThrowIfCancellationRequested();
+
+                object result = method.Invoke(null, args);
+                if (result is Task task) {
+                    await task.ConfigureAwait(false);
+                    result = call.ReturnType == GMLInteropTypeId.Void ? null : task.GetType().GetProperty(nameof(Task<object>.Result)).GetValue(task);
+                }
+
+                if (call.ReturnType != GMLInteropTypeId.Void)
+                    call.Result = WriteResult(call.ReturnType, result, call.Owner);
+            } catch (TargetInvocationException e) {
+                call.Exception = e.InnerException ?? e;
+            } catch (Exception e) {
+                call.Exception = e;
+            }
+
+            FinishedAsyncCalls.Enqueue(call);
+        }
+
+        // Unsafe code can't be in the async method itself
+        private static unsafe IntPtr WriteResult(GMLInteropTypeId returnType, object result, string owner) {
+            GMLInteropWriter writer = new();
+            writer.Write(returnType, result);
+            // Still held by C# until UpdateAsyncCalls hands it to gml, so it can't look leaked while it waits for the budget
+            return (IntPtr)writer.GetBytes(owner, handedToGML: false);
+        }
+
+        private static unsafe void DeleteAsyncCall(AsyncCall call) {
+            if (AsyncCalls.TryRemove(call.Handle, out _))
+                MemoryTracker.AsyncCalls.Remove(0);
+            if (call.Result != IntPtr.Zero)
+                GMLInteropWriter.DeleteBytes((byte*)call.Result);
+            call.Result = IntPtr.Zero;
+            call.Cancellation.Dispose();
+        }
+
+        /// <summary>
+        /// Hands up to the per-frame budget of finished calls back to gml, called every frame
+        /// </summary>
+        internal static void UpdateAsyncCalls() {
+            int completions = 0;
+            while (completions < AsyncCompletionsPerFrame.Value && FinishedAsyncCalls.TryDequeue(out AsyncCall call)) {
+                if (call.IsAbandoned) {
+                    DeleteAsyncCall(call);
+                    continue;
+                }
+
+                if (call.Exception is not null) {
+                    call.Status = GMLInteropAsyncStatus.Failed;
+                    Logger.WriteError(call.Exception);
+                } else {
+                    call.Status = GMLInteropAsyncStatus.Completed;
+                    if (call.Result != IntPtr.Zero)
+                        MemoryTracker.HandResultToGML(call.Result);
+                }
+                completions++;
+            }
+        }
+
+        private delegate int PollCSharpAsyncDelegate(long handle);
+        internal static int PollCSharpAsync(long handle) =>
+            (int)(AsyncCalls.TryGetValue(handle, out AsyncCall call) ? call.Status : GMLInteropAsyncStatus.Invalid);
+
+        private unsafe delegate int CollectCSharpAsyncDelegate(long handle, byte** resultData);
+        internal static unsafe int CollectCSharpAsync(long handle, byte** resultData) {
+            if (!AsyncCalls.TryGetValue(handle, out AsyncCall call) || call.Status == GMLInteropAsyncStatus.Pending)
+                return -1;
+
+            // The result now belongs to gml, which deletes it after reading
+            int returnType = call.Status == GMLInteropAsyncStatus.Completed ? (int)call.ReturnType : -1;
+            if (returnType > 0) {
+                *resultData = (byte*)call.Result;
+                call.Result = IntPtr.Zero;
+            }
+            DeleteAsyncCall(call);
+            return returnType;
+        }
+
+        private delegate void CancelCSharpAsyncDelegate(long handle);
+        internal static void CancelCSharpAsync(long handle) {
+            if (!AsyncCalls.TryGetValue(handle, out AsyncCall call))
+                return;
+
+            if (call.Status == GMLInteropAsyncStatus.Pending) {
+                // The handle is freed now, but the result and token source are only freed once the worker is done with them
+                if (AsyncCalls.TryRemove(handle, out _))
+                    MemoryTracker.AsyncCalls.Remove(0);
+                call.IsAbandoned = true;
+                call.Cancellation.Cancel();
+            } else
+                DeleteAsyncCall(call);
+        }
+
+        internal static string CallFromGMLAsync<T>(T function, params string[] gmlVarsOrExpressions) where T : Delegate {
+            MethodInfo method = function.Method;
+
+            ParameterInfo[] parameters = method.GetParameters();
+            if (parameters.Length > 0 && parameters[^1].ParameterType == typeof(CancellationToken))
+                parameters = parameters[..^1];
+
+            Type returnType = method.ReturnType;
+            if (returnType == typeof(Task))
+                returnType = typeof(void);
+            else if (returnType.IsGenericType && returnType.GetGenericTypeDefinition() == typeof(Task<>))
+                returnType = returnType.GetGenericArguments()[0];
+
+            return CallFromGML(GML_call_csharp_async, method, parameters, returnType, gmlVarsOrExpressions);
+        }
+
+        internal static string AsyncStatusFromGML(string handle) => $"{GML_async_status}({handle})";
+        internal static string AsyncResultFromGML(string handle) => $"{GML_async_result}({handle})";
+        internal static string AsyncCancelFromGML(string handle) => $"{GML_async_cancel}({handle})";
+
+        #endregion
+
+        #region Dispatch
+
+        private readonly struct DispatchKey : IEquatable<DispatchKey> {
+            public string ClassTypeName { get; init; }
+            public string MethodName { get; init; }
+            public Type[] ArgTypes { get; init; }
+
+            public bool Equals(DispatchKey other) => ClassTypeName == other.ClassTypeName && MethodName == other.MethodName && ArgTypes.SequenceEqual(other.ArgTypes);
+            public override bool Equals(object obj) => obj is DispatchKey other && Equals(other);
+            public override int GetHashCode() {
+                HashCode hash = new();
+                hash.Add(ClassTypeName);
+                hash.Add(MethodName);
+                foreach (Type type in ArgTypes)
+                    hash.Add(type);
+                return hash.ToHashCode();
+            }
+        }
+
+        // A resolved method, with the names its results are tracked under so they aren't formatted on every call
+        private sealed record DispatchTarget(MethodInfo Method, string ResultOwner, string AsyncResultOwner) {
+            public static DispatchTarget For(MethodInfo method) {
+                if (method is null)
+                    return null;
+                string owner = $"{method.DeclaringType.FullName}.{method.Name}";
+                return new(method, owner, $"{owner} (async)");
+            }
+        }
+
+        // Resolved methods for CallCSharp, cleared when a mod assembly is swapped so calls go to the new assembly
+        private static Dictionary<DispatchKey, DispatchTarget> DispatchTable { get; } = new();
+        // Mods each live in their own load context, so Type.GetType can't find them by name alone
+        private static Dictionary<string, Assembly> ModAssemblies { get; } = new();
+        private static Dictionary<string, HashSet<string>> CallTargetsByAssembly { get; } = new();
+
+        internal static void SetModAssembly(Assembly modDll) {
+            ModAssemblies[modDll.GetName().Name] = modDll;
+            DispatchTable.Clear();
+        }
+
+        internal static string GetCallTargetKey(MethodInfo method) =>
+            $"{method.DeclaringType.FullName}.{method.Name}({string.Join(", ", method.GetParameters().Select(param => param.ParameterType.FullName))}) -> {method.ReturnType.FullName}";
+
+        internal static IReadOnlySet<string> GetCallTargets(Assembly assembly) =>
+            CallTargetsByAssembly.TryGetValue(assembly.GetName().Name, out HashSet<string> callTargets) ? callTargets : new HashSet<string>();
+
+        // Misses are cached too, as null, so async calls without a CancellationToken don't look for one every time
+        private static DispatchTarget FindDispatchTarget(string classTypeName, string classMethodName, Type[] types) {
+            DispatchKey key = new() { ClassTypeName = classTypeName, MethodName = classMethodName, ArgTypes = types };
+            if (DispatchTable.TryGetValue(key, out DispatchTarget target))
+                return target;
+
+            Type classType = Type.GetType(classTypeName, name => ModAssemblies.TryGetValue(name.Name, out Assembly modDll) ? modDll : Assembly.Load(name), null, throwOnError: true);
+            target = DispatchTarget.For(classType.GetMethod(classMethodName, BindingFlags.Static | BindingFlags.Public | BindingFlags.NonPublic, types));
+
+            DispatchTable[key] = target;
+            return target;
+        }
+
+        private static DispatchTarget GetDispatchTarget(string classTypeName, string classMethodName, Type[] types) =>
+            FindDispatchTarget(classTypeName, classMethodName, types) ?? throw new MissingMethodException(classTypeName, classMethodName);
+
+        #endregion
     }
 }
@@ -1,6 +1,5 @@
 ﻿using SubModLoader.GMLInterop.Enums;
 using System;
-using System.Text;
 
 namespace SubModLoader.GMLInterop {
     /// <summary>
@@ -191,21 +190,15 @@ namespace SubModLoader.GMLInterop {
         /// Reads a <see cref="string"/> from the buffer
         /// </summary>
         /// <returns>The <see cref="string"/></returns>
+        /// <remarks>Short strings are cached, so reading the same string again doesn't allocate</remarks>
         public unsafe string ReadString() {
-            bool foundEnd = false;
-            int end = Offset;
-            while (!foundEnd && end < Length) {
-                if (Buffer[end] == '\0')
-                    foundEnd = true;
-                else
-                    end++;
-            }
-
-            if (!foundEnd)
+            // IndexOf is vectorized, unlike checking byte by byte
+            int length = Offset < Length ? new ReadOnlySpan<byte>(&Buffer[Offset], (int)Length - Offset).IndexOf((byte)0) : -1;
+            if (length < 0)
                 throw new IndexOutOfRangeException("Could not find end of string before end of buffer.");
 
-            string result = new((sbyte*)Buffer, Offset, end - Offset, Encoding.UTF8);
-            Offset = end + 1;
+            string result = GMLInteropStringCache.GetOrAdd(new ReadOnlySpan<byte>(&Buffer[Offset], length));
+            Offset += length + 1;
             return result;
         }
         /// <summary>
@@ -0,0 +1,46 @@
+﻿using System;
+using System.Text;
+
+namespace SubModLoader.GMLInterop {
+    /// <summary>
+    /// A bounded cache of decoded utf8 strings, so the class and method names in every call and repeated log messages aren't reallocated
+    /// </summary>
+    internal static class GMLInteropStringCache {
+        private sealed class Entry {
+            public byte[] Utf8 { get; init; }
+            public string Value { get; init; }
+        }
+
+        // Must be a power of 2
+        private const int SlotCount = 1024;
+        private const int MaxCachedLength = 128;
+
+        // Direct mapped, a colliding string replaces the old one. Entries are immutable so reads don't need a lock.
+        private static readonly Entry[] Slots = new Entry[SlotCount];
+        // The hash last missed in each slot. A string is only cached when it's missed twice in a row, so strings that never repeat cost no more than decoding them, and don't push out the ones that do.
+        private static readonly int[] MissedHashes = new int[SlotCount];
+
+        internal static string GetOrAdd(ReadOnlySpan<byte> utf8) {
+            if (utf8.IsEmpty)
+                return string.Empty;
+            if (utf8.Length > MaxCachedLength)
+                return Encoding.UTF8.GetString(utf8);
+
+            HashCode hasher = new();
+            hasher.AddBytes(utf8);
+            int hash = hasher.ToHashCode();
+            int slot = hash & (SlotCount - 1);
+
+            Entry entry = Slots[slot];
+            if (entry is not null && utf8.SequenceEqual(entry.Utf8))
+                return entry.Value;
+
+            string value = Encoding.UTF8.GetString(utf8);
+            if (MissedHashes[slot] == hash)
+                Slots[slot] = new() { Utf8 = utf8.ToArray(), Value = value };
+            else
+                MissedHashes[slot] = hash;
+            return value;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 ﻿using SubModLoader.GMLInterop.Enums;
+using SubModLoader.Utils;
 using System;
 using System.Collections.Generic;
 using System.Runtime.InteropServices;
@@ -308,11 +309,18 @@ namespace SubModLoader.GMLInterop {
         /// </summary>
         /// <returns>A new <see cref="byte"/>*</returns>
         /// <remarks>Use <see cref="DeleteBytes(byte*)"/> when finished with the returned <see cref="byte"/>*</remarks>
-        public unsafe byte* GetBytes() {
+        public unsafe byte* GetBytes() => GetBytes(GetBytesOwner);
+
+        // Looking up the caller would cost a stack walk on every call, so these are only told apart from SubModLoader's own results
+        private const string GetBytesOwner = $"{nameof(GMLInteropWriter)}.{nameof(GetBytes)}";
+
+        // The owner is shown by MemoryTracker if the bytes are never deleted
+        internal unsafe byte* GetBytes(string owner, bool handedToGML = true) {
             byte[] buffer = Buffer.ToArray();
             IntPtr bytes = Marshal.AllocHGlobal(buffer.Length + 4);
             Marshal.WriteInt32(bytes, buffer.Length + 4);
             Marshal.Copy(buffer, 0, bytes + 4, buffer.Length);
+            MemoryTracker.TrackResult(bytes, buffer.Length + 4, owner, handedToGML);
             return (byte*)bytes.ToPointer();
         }
 
@@ -321,8 +329,9 @@ namespace SubModLoader.GMLInterop {
         /// Deletes the given <see cref="byte"/>*
         /// </summary>
         /// <param name="bytes">The <see cref="byte"/>* to delete</param>
-        /// <remarks>To be safe, only use the result of <see cref="GetBytes"/> for <paramref name="bytes"/></remarks>
+        /// <remarks>To be safe, only use the result of <see cref="GetBytes()"/> for <paramref name="bytes"/></remarks>
         public static unsafe void DeleteBytes(byte* bytes) {
+            MemoryTracker.UntrackResult(new IntPtr(bytes));
             Marshal.FreeHGlobal(new IntPtr(bytes));
         }
     }
@@ -0,0 +1,354 @@
+﻿using SubmachineModLib;
+using SubmachineModLib.Models;
+using SubModLoader.GameData.Extensions;
+using SubModLoader.GMLInterop.Enums;
+using SubModLoader.Mods;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Reflection;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace SubModLoader.GMLInterop {
+    /// <summary>
+    /// A double buffered block of memory shared between gml and C#, for per-frame data too large to pass through <see cref="GMLInteropManager"/> calls
+    /// </summary>
+    /// <remarks>
+    /// The memory is a pair of gml buffers created when the game starts, C# sees them in place through <see cref="GMLSharedRegion{T}"/> without any copies.
+    /// The writer fills the back buffer then publishes it, which swaps it with the front buffer the reader sees.
+    /// </remarks>
+    public sealed class GMLSharedRegion {
+        /// <summary>
+        /// A field of the element type, as it is laid out in the buffers
+        /// </summary>
+        /// <param name="Name">The name of the field</param>
+        /// <param name="Offset">The offset of the field from the start of the element</param>
+        /// <param name="Type">The type id of the field</param>
+        public sealed record Field(string Name, int Offset, GMLInteropTypeId Type);
+
+        /// <summary>
+        /// The name of the region, also used in the names of its gml functions
+        /// </summary>
+        public string Name { get; }
+        /// <summary>
+        /// The max number of elements in each buffer
+        /// </summary>
+        public int Capacity { get; }
+        /// <summary>
+        /// The size of each element in bytes
+        /// </summary>
+        public int ElementSize { get; }
+        /// <summary>
+        /// Which side fills the region
+        /// </summary>
+        public GMLSharedRegionWriter Writer { get; }
+        /// <summary>
+        /// The fields of each element
+        /// </summary>
+        public IReadOnlyList<Field> Fields { get; }
+
+        /// <summary>
+        /// The function, in gml, that sets an element of the back buffer, called with the index of the element followed by a value for each of <see cref="Fields"/>
+        /// </summary>
+        /// <remarks>Only exists when gml is the <see cref="Writer"/></remarks>
+        public GameMakerFunction GMLSet { get; }
+        /// <summary>
+        /// The function, in gml, that publishes the back buffer to C#, called with the number of elements that were set
+        /// </summary>
+        /// <remarks>Only exists when gml is the <see cref="Writer"/></remarks>
+        public GameMakerFunction GMLPublish { get; }
+        /// <summary>
+        /// The function, in gml, that takes the latest buffer published by C# for the getters and returns its number of elements
+        /// </summary>
+        /// <remarks>Only exists when C# is the <see cref="Writer"/>. Call it once per frame before using <see cref="GetGMLGetter(string)"/></remarks>
+        public GameMakerFunction GMLRead { get; }
+
+        private Dictionary<string, GameMakerFunction> GMLGetters { get; } = new();
+
+        private unsafe NativeRegion* _native;
+
+        private string GMLPrefix => $"submodloader_shared_{Name}";
+
+        internal GMLSharedRegion(GameMakerData gameData, string name, int capacity, GMLSharedRegionWriter writer, Type elementType, int elementSize) {
+            Name = name;
+            Capacity = capacity;
+            ElementSize = elementSize;
+            Writer = writer;
+            Fields = GetFields(elementType, elementSize);
+
+            int size = capacity * elementSize;
+            GameMakerFunction init = gameData.AddCodeAndFunction($"{GMLPrefix}_init", $$"""
+                if (!variable_global_exists("{{GMLPrefix}}_region")) {
+                    global.{{GMLPrefix}}_buffer0 = buffer_create({{size}}, buffer_fixed, 1)
+                    global.{{GMLPrefix}}_buffer1 = buffer_create({{size}}, buffer_fixed, 1)
+                    buffer_fill(global.{{GMLPrefix}}_buffer0, 0, buffer_u8, 0, {{size}})
+                    buffer_fill(global.{{GMLPrefix}}_buffer1, 0, buffer_u8, 0, {{size}})
+
+                    if (!variable_global_exists("submodloader_shared_register_extern"))
+                        global.submodloader_shared_register_extern = external_define("SubModLoaderNative.dll", "SharedStateRegister", dll_cdecl, ty_real, 4, ty_string, ty_string, ty_string, ty_real)
+                    if (!variable_global_exists("submodloader_shared_publish_extern"))
+                        global.submodloader_shared_publish_extern = external_define("SubModLoaderNative.dll", "SharedStatePublish", dll_cdecl, ty_real, 2, ty_real, ty_real)
+                    if (!variable_global_exists("submodloader_shared_get_sequence_extern"))
+                        global.submodloader_shared_get_sequence_extern = external_define("SubModLoaderNative.dll", "SharedStateGetSequence", dll_cdecl, ty_real, 1, ty_real)
+                    if (!variable_global_exists("submodloader_shared_get_count_extern"))
+                        global.submodloader_shared_get_count_extern = external_define("SubModLoaderNative.dll", "SharedStateGetCount", dll_cdecl, ty_real, 2, ty_real, ty_real)
+
+                    global.{{GMLPrefix}}_region = external_call(global.submodloader_shared_register_extern, "{{Name}}", buffer_get_address(global.{{GMLPrefix}}_buffer0), buffer_get_address(global.{{GMLPrefix}}_buffer1), {{size}})
+                    global.{{GMLPrefix}}_front_buffer = global.{{GMLPrefix}}_buffer0
+                    global.{{GMLPrefix}}_back_buffer = global.{{GMLPrefix}}_buffer1
+                }
+                """).function;
+            Modding.AddOnGMLInitialize(init);
+
+            if (writer == GMLSharedRegionWriter.GML) {
+                string setFields = string.Join("\n", Fields.Select((field, i) => $"buffer_poke(buffer, offset + {field.Offset}, {ToGMLBufferType(field.Type)}, argument[{i + 1}])"));
+
+                GMLSet = gameData.AddCodeAndFunction($"{GMLPrefix}_set", $$"""
+                    var buffer = global.{{GMLPrefix}}_back_buffer
+                    var offset = argument[0] * {{elementSize}}
+                    {{setFields}}
+                    """).function;
+                // The back buffer is the one after the front buffer, which is picked by the sequence
+                GMLPublish = gameData.AddCodeAndFunction($"{GMLPrefix}_publish", $$"""
+                    var sequence = external_call(global.submodloader_shared_publish_extern, global.{{GMLPrefix}}_region, min(argument0, {{capacity}}))
+                    if ((sequence & 1) == 0) {
+                        global.{{GMLPrefix}}_front_buffer = global.{{GMLPrefix}}_buffer0
+                        global.{{GMLPrefix}}_back_buffer = global.{{GMLPrefix}}_buffer1
+                    } else {
+                        global.{{GMLPrefix}}_front_buffer = global.{{GMLPrefix}}_buffer1
+                        global.{{GMLPrefix}}_back_buffer = global.{{GMLPrefix}}_buffer0
+                    }
+                    """).function;
+            } else {
+                GMLRead = gameData.AddCodeAndFunction($"{GMLPrefix}_read", $$"""
+                    var sequence = external_call(global.submodloader_shared_get_sequence_extern, global.{{GMLPrefix}}_region)
+                    if ((sequence & 1) == 0)
+                        global.{{GMLPrefix}}_front_buffer = global.{{GMLPrefix}}_buffer0
+                    else
+                        global.{{GMLPrefix}}_front_buffer = global.{{GMLPrefix}}_buffer1
+                    return external_call(global.submodloader_shared_get_count_extern, global.{{GMLPrefix}}_region, sequence)
+                    """).function;
+
+                foreach (Field field in Fields) {
+                    GMLGetters[field.Name] = gameData.AddCodeAndFunction($"{GMLPrefix}_get_{field.Name}", $$"""
+                        return buffer_peek(global.{{GMLPrefix}}_front_buffer, argument0 * {{elementSize}} + {{field.Offset}}, {{ToGMLBufferType(field.Type)}})
+                        """).function;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Gets the function, in gml, that returns a field of an element of the buffer taken by <see cref="GMLRead"/>, called with the index of the element
+        /// </summary>
+        /// <param name="fieldName">The name of the field</param>
+        /// <returns>The getter</returns>
+        /// <exception cref="ArgumentException"></exception>
+        public GameMakerFunction GetGMLGetter(string fieldName) {
+            if (!GMLGetters.TryGetValue(fieldName, out GameMakerFunction getter))
+                throw new ArgumentException($"Region {Name} has no gml getter for field {fieldName}, getters only exist for regions that C# writes.", nameof(fieldName));
+            return getter;
+        }
+
+        #region Layout
+
+        // Only the types gml buffers can read and write directly
+        private static string ToGMLBufferType(GMLInteropTypeId id) => id switch {
+            GMLInteropTypeId.Byte => "buffer_u8",
+            GMLInteropTypeId.SByte => "buffer_s8",
+            GMLInteropTypeId.UShort => "buffer_u16",
+            GMLInteropTypeId.Short => "buffer_s16",
+            GMLInteropTypeId.UInt => "buffer_u32",
+            GMLInteropTypeId.Int => "buffer_s32",
+            GMLInteropTypeId.Long => "buffer_u64",
+            GMLInteropTypeId.Half => "buffer_f16",
+            GMLInteropTypeId.Float => "buffer_f32",
+            GMLInteropTypeId.Double => "buffer_f64",
+            GMLInteropTypeId.Bool => "buffer_bool",
+            _ => null
+        };
+
+        private static int GetSize(GMLInteropTypeId id) => id switch {
+            GMLInteropTypeId.Byte or GMLInteropTypeId.SByte or GMLInteropTypeId.Bool => 1,
+            GMLInteropTypeId.UShort or GMLInteropTypeId.Short or GMLInteropTypeId.Half => 2,
+            GMLInteropTypeId.UInt or GMLInteropTypeId.Int or GMLInteropTypeId.Float => 4,
+            _ => 8
+        };
+
+        private static List<Field> GetFields(Type elementType, int elementSize) {
+            StructLayoutAttribute layout = elementType.StructLayoutAttribute;
+            if (layout.Value == LayoutKind.Auto)
+                throw new ArgumentException($"Type {elementType} must have a sequential or explicit layout to be shared with gml.");
+            int pack = layout.Pack == 0 ? 8 : layout.Pack;
+
+            List<Field> fields = new();
+            int offset = 0, alignment = 1;
+            // Metadata order is declaration order, which sequential layout follows
+            foreach (FieldInfo field in elementType.GetFields(BindingFlags.Instance | BindingFlags.Public | BindingFlags.NonPublic).OrderBy(field => field.MetadataToken)) {
+                GMLInteropTypeId id = field.FieldType.IsPrimitive || field.FieldType.IsEnum || field.FieldType == typeof(Half) ? field.FieldType.ToGMLInteropTypeId() : GMLInteropTypeId.Void;
+                if (ToGMLBufferType(id) is null)
+                    throw new ArgumentException($"Field {field.Name} of type {field.FieldType} in {elementType} can't be read or written by a gml buffer.");
+
+                int size = GetSize(id);
+                if (layout.Value == LayoutKind.Explicit)
+                    offset = field.GetCustomAttribute<FieldOffsetAttribute>().Value;
+                else {
+                    int fieldAlignment = Math.Min(size, pack);
+                    offset = (offset + fieldAlignment - 1) / fieldAlignment * fieldAlignment;
+                    alignment = Math.Max(alignment, fieldAlignment);
+                }
+
+                fields.Add(new(field.Name, offset, id));
+                offset += size;
+            }
+
+            if (layout.Value == LayoutKind.Sequential && (offset + alignment - 1) / alignment * alignment != elementSize)
+                throw new ArgumentException($"Could not work out the layout of {elementType}, use an explicit layout.");
+
+            return fields;
+        }
+
+        #endregion
+
+        #region Native
+
+        // Mirrors SharedState::Region in SubModLoaderNative/SharedState.h
+        [StructLayout(LayoutKind.Sequential)]
+        internal unsafe struct NativeRegion {
+            public long Sequence;
+            public uint Count0;
+            public uint Count1;
+            public uint Size;
+            public byte* Buffer0;
+            public byte* Buffer1;
+
+            public byte* GetBuffer(long sequence) => (sequence & 1) == 0 ? Buffer0 : Buffer1;
+            public uint GetCount(long sequence) => (sequence & 1) == 0 ? Count0 : Count1;
+        }
+
+        [DllImport("SubModLoaderNative.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe NativeRegion* SharedStateGetRegion([MarshalAs(UnmanagedType.LPUTF8Str)] string name);
+
+        /// <summary>
+        /// True once gml has created the buffers, which happens when the game starts
+        /// </summary>
+        public unsafe bool IsConnected => GetNative() != null;
+
+        // Null until gml has registered the buffers, after that the pointer never changes
+        internal unsafe NativeRegion* GetNative() {
+            if (_native == null) {
+                try {
+                    _native = SharedStateGetRegion(Name);
+                } catch (Exception e) when (e is DllNotFoundException or EntryPointNotFoundException) {
+                    return null;
+                }
+            }
+            return _native;
+        }
+
+        #endregion
+    }
+
+    /// <summary>
+    /// A typed view of a <see cref="GMLSharedRegion"/>, get one with <see cref="GMLInteropManager.RegisterSharedRegion{T}"/> or <see cref="GMLInteropManager.GetSharedRegion{T}"/>
+    /// </summary>
+    /// <typeparam name="T">The element type, its fields must all be types gml buffers support</typeparam>
+    public sealed unsafe class GMLSharedRegion<T> where T : unmanaged {
+        /// <summary>
+        /// The elements published at a given sequence number
+        /// </summary>
+        public readonly ref struct Snapshot {
+            private readonly long* _currentSequence;
+
+            /// <summary>
+            /// The published elements, read them in place
+            /// </summary>
+            public ReadOnlySpan<T> Elements { get; }
+            /// <summary>
+            /// The number of times the writer had published when this was taken
+            /// </summary>
+            public long Sequence { get; }
+            /// <summary>
+            /// False once the writer has published again, from then on it may be writing over <see cref="Elements"/>
+            /// </summary>
+            /// <remarks>Check this after reading when reading off the game thread, gml only writes while its own code runs</remarks>
+            public bool IsCurrent => Volatile.Read(ref *_currentSequence) == Sequence;
+
+            internal Snapshot(GMLSharedRegion.NativeRegion* native, long sequence) {
+                _currentSequence = &native->Sequence;
+                Sequence = sequence;
+                Elements = new(native->GetBuffer(sequence), (int)Math.Min(native->GetCount(sequence), native->Size / (uint)sizeof(T)));
+            }
+        }
+
+        /// <summary>
+        /// The untyped region
+        /// </summary>
+        public GMLSharedRegion Region { get; }
+
+        internal GMLSharedRegion(GMLSharedRegion region) {
+            Region = region;
+        }
+
+        /// <summary>
+        /// Takes the latest elements published by gml
+        /// </summary>
+        /// <param name="snapshot">The latest elements</param>
+        /// <returns>False if gml hasn't created the region yet</returns>
+        /// <exception cref="InvalidOperationException"></exception>
+        public bool TryRead(out Snapshot snapshot) {
+            if (Region.Writer != GMLSharedRegionWriter.GML)
+                throw new InvalidOperationException($"Region {Region.Name} is written by C#, it can only be read from gml.");
+
+            snapshot = default;
+            GMLSharedRegion.NativeRegion* native = Region.GetNative();
+            if (native == null)
+                return false;
+
+            snapshot = new(native, Volatile.Read(ref native->Sequence));
+            return true;
+        }
+
+        /// <summary>
+        /// Gets the back buffer to fill before calling <see cref="Publish(int)"/>, only one thread may write at a time
+        /// </summary>
+        /// <param name="elements">The whole back buffer, up to <see cref="GMLSharedRegion.Capacity"/> elements</param>
+        /// <returns>False if gml hasn't created the region yet</returns>
+        /// <exception cref="InvalidOperationException"></exception>
+        public bool TryBeginWrite(out Span<T> elements) {
+            if (Region.Writer != GMLSharedRegionWriter.CSharp)
+                throw new InvalidOperationException($"Region {Region.Name} is written by gml, it can only be read from C#.");
+
+            elements = default;
+            GMLSharedRegion.NativeRegion* native = Region.GetNative();
+            if (native == null)
+                return false;
+
+            long back = Volatile.Read(ref native->Sequence) + 1;
+            elements = new(native->GetBuffer(back), (int)(native->Size / (uint)sizeof(T)));
+            return true;
+        }
+
+        /// <summary>
+        /// Publishes the back buffer so gml reads it from its next <see cref="GMLSharedRegion.GMLRead"/>
+        /// </summary>
+        /// <param name="count">The number of elements that were written</param>
+        /// <exception cref="InvalidOperationException"></exception>
+        public void Publish(int count) {
+            if (Region.Writer != GMLSharedRegionWriter.CSharp)
+                throw new InvalidOperationException($"Region {Region.Name} is written by gml, it can only be read from C#.");
+
+            GMLSharedRegion.NativeRegion* native = Region.GetNative();
+            if (native == null)
+                return;
+
+            long back = Volatile.Read(ref native->Sequence) + 1;
+            uint clamped = (uint)Math.Clamp(count, 0, Region.Capacity);
+            if ((back & 1) == 0)
+                native->Count0 = clamped;
+            else
+                native->Count1 = clamped;
+            Interlocked.Increment(ref native->Sequence);
+        }
+    }
+}
@@ -1,4 +1,6 @@
 ﻿using ImGuiNET;
+using SubModLoader.GMLInterop;
+using SubModLoader.Mods;
 using SubModLoader.Storage;
 using SubModLoader.Storage.Widget;
 using SubModLoader.Storage.Widget.Item;
@@ -39,6 +41,11 @@ namespace SubModLoader.GUI {
         private delegate void DrawDelegate();
         internal static void Draw() {
             try {
+                Modding.UpdateHotReload();
+                // Completed async calls are only handed to gml here, so they stop advancing whenever the Present hook doesn't run
+                GMLInteropManager.UpdateAsyncCalls();
+                MemoryTracker.Update();
+
                 if (ImGui.IsKeyPressed((ImGuiKey)ShowKey.Value, false))
                     IsOverlayShowing.Value = !IsOverlayShowing.Value;
 
@@ -52,6 +59,8 @@ namespace SubModLoader.GUI {
                         Settings.IsSettingsOpen.Value = !Settings.IsSettingsOpen.Value;
                     if (ImGui.MenuItem("Debug Console", null, Logger.IsDebugConsoleOpen.Value))
                         Logger.IsDebugConsoleOpen.Value = !Logger.IsDebugConsoleOpen.Value;
+                    if (ImGui.MenuItem("Memory", null, MemoryTracker.IsMemoryWindowOpen.Value))
+                        MemoryTracker.IsMemoryWindowOpen.Value = !MemoryTracker.IsMemoryWindowOpen.Value;
                     ImGui.EndMenu();
                 }
 
@@ -60,6 +69,8 @@ namespace SubModLoader.GUI {
                 Logger.ShowConsoleWindow();
 
                 Settings.ShowSettingsWindow();
+
+                MemoryTracker.ShowMemoryWindow();
             } catch (Exception e) {
                 Logger.WriteError(e);
             }
@@ -1,6 +1,7 @@
 ﻿using SubmachineModLib;
 using SubmachineModLib.Decompiler;
 using SubmachineModLib.Models;
+using SubModLoader.Mods;
 using System;
 using System.IO;
 using System.Linq;
@@ -19,9 +20,13 @@ namespace SubModLoader.GameData.Extensions {
         /// <param name="codeText">The code for the function</param>
         /// <returns>A 2-tuple of references to both the new code and the funtion</returns>
         /// <remarks>
-        /// If in GMS >= 2.3, this wraps your code with "<c>function {name}() { }</c>" and is treated as a global script, while in lower versions it is treated as a script
+        /// If in GMS >= 2.3, this wraps your code with "<c>function {name}() { }</c>" and is treated as a global script, while in lower versions it is treated as a script.
+        /// Returns nulls when <see cref="SubMod.IsGeneratingGML"/> is false.
         /// </remarks>
         public static (GameMakerCode code, GameMakerFunction function) AddCodeAndFunction(this GameMakerData gameData, string name, string codeText) {
+            if (Modding.IsRebuildingRegistry)
+                return (null, null);
+
             bool isv2_3 = gameData.IsVersionAtLeast(2, 3);
 
             if (isv2_3)
@@ -215,8 +220,11 @@ namespace SubModLoader.GameData.Extensions {
         /// <param name="codeText">The code text</param>
         /// <param name="isGML">True for gml, false for gml assembly</param>
         /// <param name="doParse">True to register the code in elsewhere in the game data for scripts, globals, and object events</param>
-        /// <returns>The new or replaced code</returns>
+        /// <returns>The new or replaced code, or null when <see cref="SubMod.IsGeneratingGML"/> is false</returns>
         public static GameMakerCode AddCode(this GameMakerData gameData, string codeName, string codeText, bool isGML = true, bool doParse = true) {
+            if (Modding.IsRebuildingRegistry)
+                return null;
+
             GameMakerCode code = gameData.Code.ByName(codeName);
             if (code is null) {
                 code = new() { Name = gameData.Strings.MakeString(codeName) };
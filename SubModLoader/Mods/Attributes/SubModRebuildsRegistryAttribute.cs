@@ -0,0 +1,14 @@
+﻿using System;
+
+namespace SubModLoader.Mods.Attributes {
+    /// <summary>
+    /// Lets a prebuilt modded.win be used without loading data.win, by calling <see cref="SubMod.ApplyMod(SubmachineModLib.GameMakerData)"/> without game data to rebuild only the C# side
+    /// </summary>
+    /// <remarks>
+    /// Only add this once the mod checks <see cref="SubMod.IsGeneratingGML"/>, see it for what still has to be done then.
+    /// If the rebuild doesn't match the prebuilt modded.win, it's built again by calling <see cref="SubMod.ApplyMod(SubmachineModLib.GameMakerData)"/> a second time, so it must be safe to call twice.
+    /// Unless every loaded mod has this, modded.win is always built normally.
+    /// </remarks>
+    [AttributeUsage(AttributeTargets.Assembly)]
+    public sealed class SubModRebuildsRegistryAttribute : Attribute { }
+}
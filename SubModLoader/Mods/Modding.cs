@@ -5,12 +5,19 @@ using SubModLoader.GMLInterop;
 using SubModLoader.Mods.Attributes;
 using SubModLoader.Storage;
 using SubModLoader.Utils;
+using SubModLoader.Storage.Widget;
+using SubModLoader.Storage.Widget.Item;
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Reflection;
+using System.Reflection.Emit;
+using System.Runtime.CompilerServices;
 using System.Runtime.Loader;
+using System.Security.Cryptography;
+using System.Text;
 
 // TODO: make debugger work better
 
@@ -20,33 +27,93 @@ namespace SubModLoader.Mods {
 
         internal static bool HasAppliedMods { get; private set; } = false;
 
+        // Gets unmodded.win rather than data.win in order to get the original file through SubModLoaderNative/DataWinHook.cpp
+        internal static string UnModdedDataPath { get; set; } = "unmodded.win";
+        // The real path of the original file, only used for its size and write time since opening it goes through the hook
+        internal static string OriginalDataPath { get; set; } = "data.win";
+        internal static string ModdedDataPath { get; set; } = "modded.win";
+        internal static string ModsDirectory { get; set; } = "Mods/";
+        private static string ModdedDataManifestPath => $"{ModdedDataPath}.manifest";
+        private static string ModdedDataRegistryPath => $"{ModdedDataPath}.registry";
+
+        // Set while the mods are applied without game data to rebuild only the C# side of a prebuilt modded.win, see RebuildRegistry
+        internal static bool IsRebuildingRegistry { get; private set; } = false;
+
+        private sealed class LoadedMod {
+            public string Path { get; init; }
+            public SubModLoadContext Context { get; init; }
+            public Assembly Assembly { get; init; }
+            public ISubModInfoAttribute Info { get; init; }
+            public SubMod Mod { get; init; }
+            // Hash of everything in the mod that can affect the generated gml, see GetGMLSurface
+            public string GMLSurface { get; set; }
+        }
+
         private static Assembly[] LibraryAssemblies { get; set; }
-        private static List<(ISubModInfoAttribute info, SubMod mod)> LoadedMods { get; } = new();
+        private static List<LoadedMod> LoadedMods { get; } = new();
+        private static bool HasLoadedMods { get; set; } = false;
 
         private static GameMakerData GameData { get; set; }
 
-        // Gets unmodded.win rather than data.win in order to get the original file through SubModLoaderNative/DataWinHook.cpp
+        // What the log needs from data.win, saved in the registry file so it can be shown without loading data.win
+        private sealed record GameInfo(string DisplayName, string Name, string GameMakerVersion) {
+            public static GameInfo FromGameData(GameMakerData gameData) {
+                GameMakerGeneralInfo info = gameData.GeneralInfo;
+                return new(info.DisplayName.Content, info.Name.Content, $"{info.Major}.{info.Minor}.{info.Release}.{info.Build}");
+            }
+        }
+
         public static void LoadUnModdedData() {
+            using Tracing.Span span = Tracing.Begin("LoadUnModdedData");
             Logger.WriteLine("Loading data.win...");
-            using FileStream dataWin = File.OpenRead("unmodded.win");
+            using FileStream dataWin = File.OpenRead(UnModdedDataPath);
             GameMakerData result = GameMakerIO.Read(dataWin) ?? throw new IOException("Could not load data.win");
             GameData = result;
         }
 
         private static void WriteModdedData(GameMakerData data) {
-            using FileStream moddedWin = File.OpenWrite("modded.win");
-            GameMakerIO.Write(moddedWin, data);
+            using Tracing.Span span = Tracing.Begin("WriteModdedData");
+            using (FileStream moddedWin = File.Create(ModdedDataPath))
+                GameMakerIO.Write(moddedWin, data);
+            File.WriteAllText(ModdedDataRegistryPath, DescribeRegistry(GameInfo.FromGameData(data)));
+            File.WriteAllText(ModdedDataManifestPath, GetInputManifest());
+        }
+
+        // The game info on the first three lines, then everything C# has to agree on with the gml in modded.win
+        private static string DescribeRegistry(GameInfo game) => $"{game.DisplayName}\n{game.Name}\n{game.GameMakerVersion}\n{GMLInteropManager.DescribeRegistry()}";
+
+        // Describes everything modded.win was built from, so a prebuilt one can be used when none of it has changed
+        private static string GetInputManifest() {
+            static string describe(FileInfo file) => $"{file.Name} {file.Length} {file.LastWriteTimeUtc.Ticks}";
+
+            StringBuilder manifest = new();
+            manifest.AppendLine($"SubModLoader {typeof(SubModLoader).Assembly.GetName().Version}");
+            manifest.AppendLine(describe(new(OriginalDataPath)));
+            if (Directory.Exists(ModsDirectory)) {
+                foreach (string modFile in Directory.EnumerateFiles(ModsDirectory, "*.dll").Order(StringComparer.OrdinalIgnoreCase))
+                    manifest.AppendLine(describe(new(modFile)));
+            }
+            manifest.AppendLine($"Settings {Convert.ToHexString(SHA256.HashData(Encoding.UTF8.GetBytes(Settings.DescribeModSettings())))}");
+            return manifest.ToString();
+        }
+
+        internal static bool IsPrebuiltUpToDate() {
+            try {
+                return File.Exists(ModdedDataPath) && File.Exists(ModdedDataManifestPath) && File.ReadAllText(ModdedDataManifestPath) == GetInputManifest();
+            } catch (IOException) {
+                return false;
+            }
         }
 
-        internal static void LogAssemblyInformation() {
-            GameMakerGeneralInfo info = GameData.GeneralInfo;
+        internal static void LogAssemblyInformation() => LogAssemblyInformation(GameInfo.FromGameData(GameData));
 
+        private static void LogAssemblyInformation(GameInfo game) {
             Logger.DrawLine();
             Logger.WriteLine($"SubModLoader v{typeof(SubModLoader).Assembly.GetName().Version} x{(Environment.Is64BitProcess ? "64" : "86")}");
             Logger.WriteLine("Powered by GameMakerModTool");
             Logger.WriteLine($"OS: {OSUtils.GetOSName()}");
-            Logger.WriteLine($"Game: {info.Name.Content}");
-            Logger.WriteLine($"GameMaker: v{info.Major}.{info.Minor}.{info.Release}.{info.Build}");
+            Logger.WriteLine($"Game: {game.Name}");
+            Logger.WriteLine($"GameMaker: v{game.GameMakerVersion}");
             Logger.DrawLine();
             Logger.DrawSpacer();
         }
@@ -65,33 +132,115 @@ namespace SubModLoader.Mods {
         internal static void ApplyMods() {
             Logger.GameName = GameData.GeneralInfo.DisplayName.Content;
 
-            GMLInteropManager.Initialize(GameData);
-            GMLInteropManager.Add_call_csharp(GameData);
-            Add_gml_initialize(GameData);
-            Color.AddTypeToInterop(GameData);
-            Logger.Replace_show_debug_message(GameData);
-            Logger.AddGMLFunctions(GameData);
+            using (Tracing.Begin("BuiltinMods"))
+                AddBuiltinMods(GameData);
             Logger.WriteLine("Added builtin mods...");
             Logger.DrawSpacer();
 
-            LoadMods();
-            ApplyMods(GameData);
+            // Already loaded when a rebuild of only the C# side didn't match the prebuilt modded.win
+            if (!HasLoadedMods) {
+                using (Tracing.Begin("LoadMods"))
+                    LoadMods();
+            }
+            using (Tracing.Begin("ApplyMods"))
+                ApplyMods(GameData);
 
-            GMLInteropManager.Finalize(GameData);
+            using (Tracing.Begin("GMLInteropManager.Finalize"))
+                GMLInteropManager.Finalize(GameData);
             Logger.WriteLine("Finalized gml to c# interop...");
-            Populate_gml_initialize(GameData);
+            using (Tracing.Begin("Populate_gml_initialize"))
+                Populate_gml_initialize(GameData);
             Logger.WriteLine("Populated gml initialize event...");
 
             WriteModdedData(GameData);
             Logger.WriteLine("Wrote modded.win...");
-            Logger.WriteLine("Starting game...");
             Logger.DrawSpacer();
 
-            HasAppliedMods = true;
+            FinishApplyingMods();
             GameData = null; // No futher use
         }
 
+        /// <summary>
+        /// Rebuilds only the C# side of the mods for a prebuilt modded.win, by applying them without game data so data.win doesn't have to be loaded
+        /// </summary>
+        /// <returns>False if a mod failed or what was rebuilt doesn't match modded.win, in which case it has to be built again</returns>
+        internal static bool RebuildRegistry() {
+            using Tracing.Span span = Tracing.Begin("RebuildRegistry");
+
+            string saved;
+            try {
+                saved = File.ReadAllText(ModdedDataRegistryPath);
+            } catch (IOException) {
+                return false;
+            }
+            string[] header = saved.Split('\n', 4);
+            if (header.Length < 4)
+                return false;
+            GameInfo game = new(header[0], header[1], header[2]);
+
+            LogAssemblyInformation(game);
+            Logger.WriteLine($"Using prebuilt {ModdedDataPath}...");
+            Logger.GameName = game.DisplayName;
+
+            bool succeeded;
+            IsRebuildingRegistry = true;
+            try {
+                AddBuiltinMods(null);
+                using (Tracing.Begin("LoadMods"))
+                    LoadMods();
+
+                // ApplyMod is only called without game data for mods that expect it
+                List<string> unsupported = LoadedMods.Where(loaded => loaded.Assembly.GetCustomAttribute<SubModRebuildsRegistryAttribute>() is null).Select(loaded => loaded.Info.Name).ToList();
+                if (unsupported.Count > 0) {
+                    Logger.WriteLine($"{string.Join(", ", unsupported)} can't use the prebuilt {ModdedDataPath}, building it again");
+                    Logger.DrawSpacer();
+                    return false;
+                }
+
+                succeeded = ApplyMods(null);
+            } catch (Exception e) {
+                Logger.WriteError(e);
+                succeeded = false;
+            } finally {
+                IsRebuildingRegistry = false;
+            }
+
+            if (!succeeded || DescribeRegistry(game) != saved) {
+                Logger.WriteWarning($"The mods no longer match the prebuilt {ModdedDataPath}, building it again");
+                Logger.DrawSpacer();
+                return false;
+            }
+
+            FinishApplyingMods();
+            return true;
+        }
+
+        private static void FinishApplyingMods() {
+            foreach (LoadedMod loaded in LoadedMods)
+                loaded.GMLSurface = GetGMLSurface(loaded.Assembly, GMLInteropManager.GetCallTargets(loaded.Assembly));
+
+            HasAppliedMods = true;
+        }
+
+        // Only what C# needs is added when rebuilding the registry, the rest only generates gml
+        private static void AddBuiltinMods(GameMakerData gameData) {
+            OnGMLInitializeEvents.Clear();
+
+            GMLInteropManager.Initialize(gameData);
+            if (!IsRebuildingRegistry) {
+                GMLInteropManager.Add_call_csharp(gameData);
+                Add_gml_initialize(gameData);
+            }
+            Color.AddTypeToInterop(gameData);
+            if (!IsRebuildingRegistry) {
+                Logger.Replace_show_debug_message(gameData);
+                Logger.AddGMLFunctions(gameData);
+            }
+        }
+
         private static void LoadMods() {
+            HasLoadedMods = true;
+
             // TODO: figure out a better fix for this
             // idk why this happens, but for some reason loading new assemblies loads a new "DefaultContext" with assemblies loading a second time unless I do this
             LibraryAssemblies = AppDomain.CurrentDomain.GetAssemblies();
@@ -100,26 +249,19 @@ namespace SubModLoader.Mods {
                 return lib;
             };
 
-            if (!Directory.Exists("Mods/"))
-                Directory.CreateDirectory("Mods/");
+            if (!Directory.Exists(ModsDirectory))
+                Directory.CreateDirectory(ModsDirectory);
 
-            foreach (string modFile in Directory.EnumerateFiles("Mods/", "*.dll")) {
+            foreach (string modFile in Directory.EnumerateFiles(ModsDirectory, "*.dll")) {
                 try {
-                    Assembly modDll = AssemblyLoadContext.Default.LoadFromAssemblyPath(Path.GetFullPath(modFile));
-
-                    ISubModInfoAttribute info = modDll.GetCustomAttributes().FirstOrDefault(attr => attr is ISubModInfoAttribute) as ISubModInfoAttribute;
-                    if (info is null)
-                        return; // not a mod
-                    LogModInformation(info);
-
-                    SubModColorAttribute color = modDll.GetCustomAttribute<SubModColorAttribute>();
-
-                    SubMod mod = (SubMod)Activator.CreateInstance(info.ModType);
-                    mod.Logger = new(info.Name, color?.AuthorColor ?? Color.Empty);
-                    mod.Settings = Settings.GetSettings(info.Name);
-                    LoadedMods.Add((info, mod));
-
-                    mod.OnLoad();
+                    LoadedMod loaded = LoadMod(modFile);
+                    if (loaded is null)
+                        continue; // not a mod
+                    LoadedMods.Add(loaded);
+                    GMLInteropManager.SetModAssembly(loaded.Assembly);
+
+                    using (Tracing.Begin("OnLoad", loaded.Info.Name))
+                        loaded.Mod.OnLoad();
                     Logger.DrawSpacer();
                 } catch (Exception e) {
                     Logger.WriteError($"Failed to load mod at \"{modFile}\" because: {e}");
@@ -128,17 +270,55 @@ namespace SubModLoader.Mods {
             }
         }
 
-        private static void ApplyMods(GameMakerData GameData) {
-            foreach ((ISubModInfoAttribute info, SubMod mod) in LoadedMods) {
+        // Each mod gets its own collectible context so that it can be swapped out by hot reloading
+        private static LoadedMod LoadMod(string modFile) {
+            string path = Path.GetFullPath(modFile);
+            SubModLoadContext context = new(path, LibraryAssemblies, FindLoadedModAssembly);
+            Assembly modDll = context.LoadMod();
+
+            ISubModInfoAttribute info = modDll.GetCustomAttributes().FirstOrDefault(attr => attr is ISubModInfoAttribute) as ISubModInfoAttribute;
+            if (info is null) {
+                context.Unload();
+                return null;
+            }
+            LogModInformation(info);
+
+            SubModColorAttribute color = modDll.GetCustomAttribute<SubModColorAttribute>();
+
+            SubMod mod = (SubMod)Activator.CreateInstance(info.ModType);
+            mod.Logger = new(info.Name, color?.AuthorColor ?? Color.Empty);
+            mod.Settings = Settings.GetSettings(info.Name);
+
+            return new() {
+                Path = path,
+                Context = context,
+                Assembly = modDll,
+                Info = info,
+                Mod = mod
+            };
+        }
+
+        private static Assembly FindLoadedModAssembly(AssemblyName assemblyName) =>
+            LoadedMods.FirstOrDefault(loaded => loaded.Assembly.GetName().Name == assemblyName.Name)?.Assembly;
+
+        // Returns false if any mod failed
+        private static bool ApplyMods(GameMakerData GameData) {
+            bool succeeded = true;
+
+            foreach ((ISubModInfoAttribute info, SubMod mod) in LoadedMods.Select(loaded => (loaded.Info, loaded.Mod))) {
                 try {
                     Logger.WriteLine($"Applying {info.Name}...");
-                    mod.ApplyMod(GameData);
+                    using (Tracing.Begin("ApplyMod", info.Name))
+                        mod.ApplyMod(GameData);
                     Logger.DrawSpacer();
                 } catch (Exception e) {
                     Logger.WriteError($"Failed to apply mod \"{info.Name}\" because: {e}");
                     Logger.DrawSpacer();
+                    succeeded = false;
                 }
             }
+
+            return succeeded;
         }
 
         #region Builtin Mods
@@ -178,5 +358,266 @@ namespace SubModLoader.Mods {
         #endregion
 
         #endregion
+
+        #region Hot reload
+
+        private static SettingsCategory ModsCategory { get; } = Settings.SubModLoaderSettings.GetCategory("Mods");
+#if DEBUG
+        private const bool hotReloadModsDefault = true;
+#else
+        private const bool hotReloadModsDefault = false;
+#endif
+        private static SettingsBool HotReloadMods { get; } = SettingsBool.Get(ModsCategory, "HotReloadMods", hotReloadModsDefault,
+                                                                              showInImGui: true, "Hot Reload Mods", "Whether mods are reloaded while the game is running when their dll changes. Changes to what a mod adds to gml, and mods that register interop types, still need a restart.");
+
+        // Builds write to the dll more than once, so wait for it to settle
+        private static readonly TimeSpan HotReloadDelay = TimeSpan.FromMilliseconds(500);
+        private const int MaxUnloadAttempts = 10;
+        // Collecting blocks the game thread, so it's only tried this often rather than every frame
+        private static readonly TimeSpan UnloadCollectInterval = TimeSpan.FromMilliseconds(500);
+        private static DateTime NextUnloadCollect { get; set; } = DateTime.MinValue;
+
+        private static FileSystemWatcher ModsWatcher { get; set; }
+        private static ConcurrentDictionary<string, DateTime> PendingReloads { get; } = new(StringComparer.OrdinalIgnoreCase);
+        private static List<(string name, WeakReference context, int attempts)> UnloadingContexts { get; } = new();
+
+        internal static void WatchMods() {
+            ModsWatcher = new(Path.GetFullPath(ModsDirectory), "*.dll") {
+                NotifyFilter = NotifyFilters.FileName | NotifyFilters.LastWrite | NotifyFilters.Size
+            };
+            ModsWatcher.Changed += (_, e) => PendingReloads[e.FullPath] = DateTime.UtcNow;
+            ModsWatcher.Created += (_, e) => PendingReloads[e.FullPath] = DateTime.UtcNow;
+            ModsWatcher.Renamed += (_, e) => PendingReloads[e.FullPath] = DateTime.UtcNow;
+            ModsWatcher.EnableRaisingEvents = true;
+        }
+
+        // Called every frame on the game thread, which is the same thread gml calls into C# on
+        internal static void UpdateHotReload() {
+            CollectUnloadedContexts();
+
+            if (PendingReloads.IsEmpty)
+                return;
+
+            DateTime now = DateTime.UtcNow;
+            foreach ((string path, DateTime changed) in PendingReloads) {
+                if (now - changed < HotReloadDelay)
+                    continue;
+                if (!PendingReloads.TryRemove(new(path, changed)))
+                    continue; // changed again in the meantime
+
+                if (HotReloadMods.Value)
+                    ReloadMod(path);
+            }
+        }
+
+        private static void ReloadMod(string path) {
+            int index = LoadedMods.FindIndex(loaded => string.Equals(loaded.Path, path, StringComparison.OrdinalIgnoreCase));
+            if (index < 0) {
+                Logger.WriteWarning($"Found new mod at \"{path}\", restart the game to load it");
+                return;
+            }
+            LoadedMod old = LoadedMods[index];
+
+            // The registered types were created from the old assembly, swapping it would leave gml reading and writing the old Types
+            List<Type> registeredTypes = GMLInteropManager.GetRegisteredTypesOwnedBy(old.Assembly);
+            if (registeredTypes.Count > 0) {
+                Logger.WriteWarning($"{old.Info.Name} registers interop types ({string.Join(", ", registeredTypes.Select(type => type.Name))}) which can't be reloaded, restart the game to apply it");
+                return;
+            }
+
+            // Mods that use this one would keep calling into the old assembly, and keep it from unloading
+            List<string> dependents = LoadedMods.Where(loaded => loaded.Context.DependsOn(old.Assembly)).Select(loaded => loaded.Info.Name).ToList();
+            if (dependents.Count > 0) {
+                Logger.WriteWarning($"{old.Info.Name} is used by {string.Join(", ", dependents)} and can't be reloaded, restart the game to apply it");
+                return;
+            }
+
+            using Tracing.Span span = Tracing.Begin("HotReload", old.Info.Name);
+            Logger.WriteLine($"Reloading {old.Info.Name}...");
+
+            LoadedMod reloaded;
+            try {
+                reloaded = LoadMod(path);
+            } catch (Exception e) {
+                Logger.WriteError($"Failed to reload mod \"{old.Info.Name}\" because: {e}");
+                return;
+            }
+
+            if (reloaded is null) {
+                Logger.WriteWarning($"\"{path}\" is no longer a mod, restart the game to unload {old.Info.Name}");
+                return;
+            }
+
+            reloaded.GMLSurface = GetGMLSurface(reloaded.Assembly, GMLInteropManager.GetCallTargets(old.Assembly));
+            if (reloaded.Info.Name != old.Info.Name || reloaded.GMLSurface != old.GMLSurface) {
+                Logger.WriteWarning($"{old.Info.Name} changed what it adds to gml, restart the game to apply it");
+                reloaded.Context.Unload();
+                return;
+            }
+
+            try {
+                old.Mod.OnUnload();
+            } catch (Exception e) {
+                Logger.WriteError($"Failed to unload mod \"{old.Info.Name}\" because: {e}");
+            }
+
+            LoadedMods[index] = reloaded;
+            GMLInteropManager.SetModAssembly(reloaded.Assembly);
+
+            try {
+                reloaded.Mod.OnLoad();
+            } catch (Exception e) {
+                Logger.WriteError($"Failed to load mod \"{reloaded.Info.Name}\" because: {e}");
+            }
+
+            old.Context.Unload();
+            UnloadingContexts.Add((old.Info.Name, new WeakReference(old.Context), 0));
+
+            Logger.WriteSuccess($"Reloaded {reloaded.Info.Name}");
+            Logger.DrawSpacer();
+        }
+
+        // Unloading only finishes once nothing references the old context, so collect a few times before giving up
+        private static void CollectUnloadedContexts() {
+            if (UnloadingContexts.Count == 0)
+                return;
+
+            DateTime now = DateTime.UtcNow;
+            if (now < NextUnloadCollect)
+                return;
+            NextUnloadCollect = now + UnloadCollectInterval;
+
+            GC.Collect();
+            GC.WaitForPendingFinalizers();
+
+            for (int i = UnloadingContexts.Count - 1; i >= 0; i--) {
+                (string name, WeakReference context, int attempts) = UnloadingContexts[i];
+                if (!context.IsAlive) {
+                    Logger.WriteLine($"Unloaded previous version of {name}");
+                    UnloadingContexts.RemoveAt(i);
+                } else if (attempts + 1 >= MaxUnloadAttempts) {
+                    Logger.WriteWarning($"Previous version of {name} is still referenced and could not be unloaded");
+                    UnloadingContexts.RemoveAt(i);
+                } else
+                    UnloadingContexts[i] = (name, context, attempts + 1);
+            }
+        }
+
+        // The generated gml only depends on the signatures of the methods called from gml, so their bodies can change freely.
+        // Everything else is hashed with its IL since it could change the gml that ApplyMod generates.
+        private static string GetGMLSurface(Assembly modDll, IReadOnlySet<string> callTargets) {
+            const BindingFlags declared = BindingFlags.Public | BindingFlags.NonPublic | BindingFlags.Static | BindingFlags.Instance | BindingFlags.DeclaredOnly;
+
+            Type[] types = modDll.GetTypes();
+
+            // The compiler moves parts of a body into state machines and lambdas, which have to be skipped along with it
+            HashSet<string> skippedBodies = new(StringComparer.Ordinal);
+            HashSet<Type> skippedStateMachines = new();
+            foreach (Type type in types) {
+                foreach (MethodInfo method in type.GetMethods(declared)) {
+                    if (!callTargets.Contains(GMLInteropManager.GetCallTargetKey(method)) && !IsRuntimeOnly(method))
+                        continue;
+                    skippedBodies.Add($"{type.FullName}::{method.Name}");
+                    if (method.GetCustomAttribute<StateMachineAttribute>() is StateMachineAttribute stateMachine)
+                        skippedStateMachines.Add(stateMachine.StateMachineType);
+                }
+            }
+
+            using IncrementalHash hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256);
+            foreach (Type type in types.OrderBy(type => type.FullName, StringComparer.Ordinal)) {
+                // Their members only matter through the IL that uses them, which is hashed by name
+                bool isGenerated = type.IsDefined(typeof(CompilerGeneratedAttribute), false);
+                if (isGenerated && skippedStateMachines.Contains(type))
+                    continue;
+
+                if (!isGenerated) {
+                    foreach (FieldInfo field in type.GetFields(declared).OrderBy(field => field.Name, StringComparer.Ordinal))
+                        hash.AppendData(Encoding.UTF8.GetBytes($"{type.FullName}::{field}"));
+                }
+
+                IEnumerable<MethodBase> methods = type.GetMethods(declared).Cast<MethodBase>().Concat(type.GetConstructors(declared));
+                foreach (MethodBase method in methods.OrderBy(method => method.ToString(), StringComparer.Ordinal)) {
+                    bool isGeneratedMethod = isGenerated || method.IsDefined(typeof(CompilerGeneratedAttribute), false) && method.Name.StartsWith('<');
+                    if (!isGeneratedMethod)
+                        hash.AppendData(Encoding.UTF8.GetBytes($"{type.FullName}::{method}"));
+
+                    // The constructors of closures and state machines are always the same, and they show up as soon as a skipped body gets a lambda
+                    if (isGenerated && method is ConstructorInfo || skippedBodies.Contains(GetBodyOwner(method)))
+                        continue;
+
+                    AppendIL(hash, method);
+                }
+            }
+
+            return Convert.ToHexString(hash.GetHashAndReset());
+        }
+
+        // Lambdas, local functions and state machines are named after the method they came from, as in <Method>b__0_0
+        private static string GetBodyOwner(MethodBase method) {
+            Type owner = method.DeclaringType;
+            string name = method.Name;
+            while (owner.DeclaringType is not null && owner.IsDefined(typeof(CompilerGeneratedAttribute), false)) {
+                if (!name.StartsWith('<'))
+                    name = owner.Name;
+                owner = owner.DeclaringType;
+            }
+
+            if (name.StartsWith('<') && name.IndexOf('>') is int end and > 1)
+                name = name[1..end];
+            return $"{owner.FullName}::{name}";
+        }
+
+        private static Dictionary<short, OpCode> OpCodesByValue { get; } =
+            typeof(OpCodes).GetFields(BindingFlags.Public | BindingFlags.Static).Select(field => (OpCode)field.GetValue(null)).ToDictionary(opCode => opCode.Value);
+
+        // Metadata tokens shift whenever a string or member reference is added anywhere in the mod, so they're hashed by what they resolve to
+        private static void AppendIL(IncrementalHash hash, MethodBase method) {
+            byte[] il = method.GetMethodBody()?.GetILAsByteArray();
+            if (il is null)
+                return;
+
+            Type[] typeArguments = method.DeclaringType.IsGenericType ? method.DeclaringType.GetGenericArguments() : null;
+            Type[] methodArguments = method.IsGenericMethod ? method.GetGenericArguments() : null;
+
+            int offset = 0;
+            while (offset < il.Length) {
+                short value = il[offset++];
+                if (value == OpCodes.Prefix1.Value)
+                    value = (short)(value << 8 | il[offset++]);
+                OpCode opCode = OpCodesByValue[value];
+                hash.AppendData(BitConverter.GetBytes(value));
+
+                int operandSize = opCode.OperandType switch {
+                    OperandType.InlineNone => 0,
+                    OperandType.ShortInlineBrTarget or OperandType.ShortInlineI or OperandType.ShortInlineVar => 1,
+                    OperandType.InlineVar => 2,
+                    OperandType.InlineI8 or OperandType.InlineR => 8,
+                    OperandType.InlineSwitch => 4 + 4 * BitConverter.ToInt32(il, offset),
+                    _ => 4
+                };
+
+                if (opCode.OperandType is OperandType.InlineString or OperandType.InlineMethod or OperandType.InlineField or OperandType.InlineType or OperandType.InlineTok) {
+                    int token = BitConverter.ToInt32(il, offset);
+                    string resolved;
+                    try {
+                        resolved = opCode.OperandType == OperandType.InlineString ? method.Module.ResolveString(token) : method.Module.ResolveMember(token, typeArguments, methodArguments) switch {
+                            Type type => type.FullName ?? type.Name,
+                            MemberInfo member => $"{member.DeclaringType?.FullName}::{member}"
+                        };
+                    } catch (ArgumentException) {
+                        resolved = token.ToString();
+                    }
+                    hash.AppendData(Encoding.UTF8.GetBytes(resolved));
+                } else
+                    hash.AppendData(il, offset, operandSize);
+
+                offset += operandSize;
+            }
+        }
+
+        private static bool IsRuntimeOnly(MethodInfo method) =>
+            method.GetBaseDefinition().DeclaringType == typeof(SubMod) && method.Name is nameof(SubMod.OnLoad) or nameof(SubMod.Draw) or nameof(SubMod.OnUnload);
+
+        #endregion
     }
 }
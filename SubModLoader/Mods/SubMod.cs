@@ -2,6 +2,7 @@
 using SubmachineModLib;
 using SubmachineModLib.Models;
 using SubModLoader.GMLInterop;
+using SubModLoader.Mods.Attributes;
 using SubModLoader.Storage;
 using SubModLoader.Utils;
 using System;
@@ -25,6 +26,16 @@ namespace SubModLoader.Mods {
         /// </summary>
         public static bool HasAppliedMods => Modding.HasAppliedMods;
 
+        /// <summary>
+        /// False while <see cref="ApplyMod(GameMakerData)"/> only runs to rebuild the C# side for a prebuilt modded.win, in which case its game data is <see langword="null"/>
+        /// </summary>
+        /// <remarks>
+        /// This only happens when every loaded mod has <see cref="SubModRebuildsRegistryAttribute"/>.
+        /// Registering interop types and shared regions, <see cref="CallFromGML{T}(T, string[])"/> and the AddCode extensions still work then and must be done the same way.
+        /// Skip anything else that uses the game data, otherwise the mod fails and modded.win is built again.
+        /// </remarks>
+        public static bool IsGeneratingGML => !Modding.IsRebuildingRegistry;
+
         #region Virtual Funcs
 
         /// <summary>
@@ -35,7 +46,7 @@ namespace SubModLoader.Mods {
         /// <summary>
         /// Called when the mod is expected to modify game data
         /// </summary>
-        /// <param name="data">The game data for modification</param>
+        /// <param name="data">The game data for modification, <see langword="null"/> when <see cref="IsGeneratingGML"/> is false</param>
         public virtual void ApplyMod(GameMakerData data) { }
 
         /// <summary>
@@ -43,10 +54,10 @@ namespace SubModLoader.Mods {
         /// </summary>
         public virtual void Draw() { }
 
-        // TODO: implement or remove
         /// <summary>
-        /// Called when the mod is unloaded
+        /// Called when the mod is unloaded before being hot reloaded, release anything that would keep the old version alive here
         /// </summary>
+        /// <remarks>The new version gets <see cref="OnLoad"/> but not <see cref="ApplyMod(GameMakerData)"/>, since the game data has already been written</remarks>
         public virtual void OnUnload() { }
 
         #endregion
@@ -68,6 +79,39 @@ namespace SubModLoader.Mods {
         /// </remarks>
         public static string CallFromGML<T>(T function, params string[] gmlVarsOrExpressions) where T : Delegate => GMLInteropManager.CallFromGML(function, gmlVarsOrExpressions);
 
+        /// <summary>
+        /// Allows C# function calls within gml that run on a worker thread, the gml gets a handle right away instead of the result
+        /// </summary>
+        /// <typeparam name="T">The function type</typeparam>
+        /// <param name="function">The function, which may return a <see cref="System.Threading.Tasks.Task"/> to await and may take a trailing <see cref="System.Threading.CancellationToken"/> that gml doesn't supply</param>
+        /// <param name="gmlVarsOrExpressions">The variables and expressions within gml to be evaluated for the function parameters</param>
+        /// <remarks>
+        /// Use <see cref="AsyncStatusFromGML(string)"/> each frame until the call is no longer pending, then <see cref="AsyncResultFromGML(string)"/> to get the result.
+        /// The function must be thread safe, and has the same limitations as <see cref="CallFromGML{T}(T, string[])"/>.
+        /// </remarks>
+        public static string CallFromGMLAsync<T>(T function, params string[] gmlVarsOrExpressions) where T : Delegate => GMLInteropManager.CallFromGMLAsync(function, gmlVarsOrExpressions);
+
+        /// <summary>
+        /// Gets the gml that returns the <see cref="GMLInterop.Enums.GMLInteropAsyncStatus"/> of a call started with <see cref="CallFromGMLAsync{T}(T, string[])"/>
+        /// </summary>
+        /// <param name="handle">The gml variable or expression holding the handle</param>
+        /// <returns>The gml expression</returns>
+        public static string AsyncStatusFromGML(string handle) => GMLInteropManager.AsyncStatusFromGML(handle);
+
+        /// <summary>
+        /// Gets the gml that returns the result of a finished call started with <see cref="CallFromGMLAsync{T}(T, string[])"/> and frees its handle
+        /// </summary>
+        /// <param name="handle">The gml variable or expression holding the handle</param>
+        /// <returns>The gml expression, which is undefined if the call is still pending, failed, was cancelled or returns <see langword="void"/></returns>
+        public static string AsyncResultFromGML(string handle) => GMLInteropManager.AsyncResultFromGML(handle);
+
+        /// <summary>
+        /// Gets the gml that cancels a call started with <see cref="CallFromGMLAsync{T}(T, string[])"/> and frees its handle
+        /// </summary>
+        /// <param name="handle">The gml variable or expression holding the handle</param>
+        /// <returns>The gml expression</returns>
+        public static string AsyncCancelFromGML(string handle) => GMLInteropManager.AsyncCancelFromGML(handle);
+
         /// <summary>
         /// Adds the function to be called when the game starts in gml
         /// </summary>
@@ -0,0 +1,55 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Reflection;
+using System.Runtime.Loader;
+
+namespace SubModLoader.Mods {
+    /// <summary>
+    /// A collectible load context for a single mod, so it can be unloaded when the mod is hot reloaded
+    /// </summary>
+    internal sealed class SubModLoadContext : AssemblyLoadContext {
+        private string ModPath { get; }
+        private IReadOnlyList<Assembly> LibraryAssemblies { get; }
+        private Func<AssemblyName, Assembly> FindModAssembly { get; }
+        // Other mods' assemblies this mod has resolved, which keep them from being unloaded
+        private HashSet<Assembly> ModDependencies { get; } = new();
+
+        internal SubModLoadContext(string modPath, IReadOnlyList<Assembly> libraryAssemblies, Func<AssemblyName, Assembly> findModAssembly) : base(Path.GetFileNameWithoutExtension(modPath), isCollectible: true) {
+            ModPath = modPath;
+            LibraryAssemblies = libraryAssemblies;
+            FindModAssembly = findModAssembly;
+        }
+
+        internal bool DependsOn(Assembly modDll) => ModDependencies.Contains(modDll);
+
+        // Loaded from memory so the file isn't locked and can be overwritten while the game is running
+        private Assembly LoadFromFile(string path) {
+            using MemoryStream assembly = new(File.ReadAllBytes(path));
+            return LoadFromStream(assembly);
+        }
+
+        internal Assembly LoadMod() => LoadFromFile(ModPath);
+
+        protected override Assembly Load(AssemblyName assemblyName) {
+            // SubModLoader and its libraries have to be shared so that mods see the same types as the loader
+            Assembly library = LibraryAssemblies.FirstOrDefault(asm => asm.GetName().Name == assemblyName.Name);
+            if (library is not null)
+                return library;
+
+            // Other mods are shared too, a second copy would have its own statics and types
+            Assembly mod = FindModAssembly(assemblyName);
+            if (mod is not null) {
+                ModDependencies.Add(mod);
+                return mod;
+            }
+
+            string dependency = Path.Combine(Path.GetDirectoryName(ModPath), $"{assemblyName.Name}.dll");
+            if (File.Exists(dependency))
+                return LoadFromFile(dependency);
+
+            return null;
+        }
+    }
+}
@@ -7,6 +7,7 @@ using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Numerics;
+using System.Text;
 using System.Text.RegularExpressions;
 
 namespace SubModLoader.Storage {
@@ -90,6 +91,24 @@ namespace SubModLoader.Storage {
 
         internal static SettingsBool IsSettingsOpen { get; private set; }
 
+        internal static int CountItems() => AllSettings.Sum(settings => settings.Categories.Sum(category => category.CountItems()));
+
+        // Mods can read their settings in ApplyMod, so these are part of what modded.win is built from. SubModLoader's own are only read at runtime.
+        // Loaded and used categories give the same description, and empty ones are skipped since they aren't saved until something else is.
+        internal static string DescribeModSettings() {
+            StringBuilder description = new();
+
+            foreach (Settings settings in AllSettings.Where(settings => settings != SubModLoaderSettings)) {
+                foreach (SettingsCategory category in settings.Categories) {
+                    string items = category.Save();
+                    if (items.Length > 0)
+                        description.AppendLine($"[{settings.Caller}##{category.Name}]").Append(items);
+                }
+            }
+
+            return description.ToString();
+        }
+
         internal static Settings GetSettings(string caller) {
             int index = AllSettings.FindIndex(settings => settings.Caller == caller);
             if (index < 0) {
@@ -163,6 +182,7 @@ namespace SubModLoader.Storage {
             SettingsCategory settingsSettingsCategory = GetSettings(SubModLoaderSettingsName).GetCategory("Settings", false);
             SubModLoaderSettings.GetCategory("Overlay");
             SubModLoaderSettings.GetCategory("Logger");
+            SubModLoaderSettings.GetCategory("Mods");
 
             IsSettingsOpen = SettingsBool.Get(settingsSettingsCategory, "IsSettingsOpen", false);
         }
@@ -24,6 +24,8 @@ namespace SubModLoader.Storage.Widget {
 
         internal SettingsCategory() { }
 
+        internal int CountItems() => Items.Count + Categories.Sum(category => category.CountItems());
+
         /// <summary>
         /// Retrieves or creates a subcategory
         /// </summary>
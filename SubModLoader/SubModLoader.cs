@@ -5,16 +5,25 @@ using System;
 
 namespace SubModLoader {
     internal static class SubModLoader {
+        // Startup is much faster with a prebuilt modded.win, so the report keeps a separate baseline for it
+        private static bool UsedPrebuilt { get; set; } = false;
+
         private delegate bool EntryPointDelegate();
         internal static bool EntryPoint() => Initialize();
 
         private static bool Initialize() {
             try {
-                Settings.Load();
+                using (Tracing.Begin("Settings.Load"))
+                    Settings.Load();
 
-                Modding.LoadUnModdedData();
-                Modding.LogAssemblyInformation();
-                Modding.ApplyMods();
+                // A prebuilt modded.win only needs the C# side of the mods, which is rebuilt without loading data.win
+                UsedPrebuilt = Modding.IsPrebuiltUpToDate() && Modding.RebuildRegistry();
+                if (!UsedPrebuilt)
+                    BuildModdedData();
+
+                Modding.WatchMods();
+                Logger.WriteLine("Starting game...");
+                Logger.DrawSpacer();
             } catch (Exception e) {
                 Logger.WriteError(e);
                 return false;
@@ -22,5 +31,21 @@ namespace SubModLoader {
 
             return true;
         }
+
+        private delegate void WriteStartupReportDelegate();
+        // Called by native once its span around EntryPoint has closed, so the report includes it
+        internal static void WriteStartupReport() {
+            Tracing.WriteReport(UsedPrebuilt ? "Prebuilt" : "Build");
+            MemoryTracker.WriteDumpNowAndOnExit();
+        }
+
+        // Also used by SubModLoaderCLI to build modded.win outside of the game
+        internal static void BuildModdedData() {
+            using (Tracing.Begin("BuildModdedData")) {
+                Modding.LoadUnModdedData();
+                Modding.LogAssemblyInformation();
+                Modding.ApplyMods();
+            }
+        }
     }
 }
@@ -1,6 +1,7 @@
 ﻿using SubmachineModLib;
 using SubModLoader.GameData.Extensions;
 using SubModLoader.GMLInterop;
+using SubModLoader.Mods;
 using System;
 using System.Diagnostics.CodeAnalysis;
 using System.Numerics;
@@ -184,8 +185,6 @@ namespace SubModLoader.Utils {
             }
         };
         internal static void AddTypeToInterop(GameMakerData gameData) {
-            AreStructsAvailable = gameData.IsVersionAtLeast(2, 3);
-
             static void writeCSharp(GMLInteropWriter w, Color v) {
                 w.WriteByte((byte)v.Type);
                 switch (v.Type) {
@@ -214,6 +213,13 @@ namespace SubModLoader.Utils {
                 }
             }
 
+            // Only the id and the C# side are needed to match a prebuilt modded.win
+            if (Modding.IsRebuildingRegistry) {
+                GMLInteropManager.RegisterType(gameData, writeCSharp, readCSharp, "", "");
+                return;
+            }
+
+            AreStructsAvailable = gameData.IsVersionAtLeast(2, 3);
             if (AreStructsAvailable) {
                 gameData.AddCode("gml_GlobalScript_submodloader_color_constructor", $$"""
                     function Color() constructor {
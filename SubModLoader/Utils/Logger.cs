@@ -497,6 +497,7 @@ namespace SubModLoader.Utils {
                 IsNegative = modifiers.Contains(ConsoleModifier.Negative),
                 IsStrike = modifiers.Contains(ConsoleModifier.Strike)
             });
+            MemoryTracker.LogData.Add(message.Length * sizeof(char));
 
             PreviousCaller = alwaysShowCaller ? null : caller;
 
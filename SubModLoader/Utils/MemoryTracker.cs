@@ -0,0 +1,300 @@
+﻿using ImGuiNET;
+using SubModLoader.GMLInterop;
+using SubModLoader.Storage;
+using SubModLoader.Storage.Widget;
+using SubModLoader.Storage.Widget.Item;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Numerics;
+using System.Text.Json;
+using System.Threading;
+
+namespace SubModLoader.Utils {
+    /// <summary>
+    /// Counts the memory SubModLoader itself holds on to per subsystem, and finds interop results that gml never deleted
+    /// </summary>
+    internal static class MemoryTracker {
+        internal sealed class Counter {
+            private long _bytes;
+            private long _peakBytes;
+            private long _count;
+            private long _peakCount;
+
+            public string Name { get; }
+            // Some subsystems can only be counted, or only sized
+            public bool HasBytes { get; }
+            public bool HasCount { get; }
+            public long Bytes => Interlocked.Read(ref _bytes);
+            public long PeakBytes => Interlocked.Read(ref _peakBytes);
+            public long Count => Interlocked.Read(ref _count);
+            public long PeakCount => Interlocked.Read(ref _peakCount);
+
+            internal Counter(string name, bool hasBytes, bool hasCount) {
+                Name = name;
+                HasBytes = hasBytes;
+                HasCount = hasCount;
+            }
+
+            public void Add(long bytes, long count = 1) {
+                UpdatePeak(ref _peakBytes, Interlocked.Add(ref _bytes, bytes));
+                UpdatePeak(ref _peakCount, Interlocked.Add(ref _count, count));
+            }
+
+            public void Remove(long bytes, long count = 1) {
+                Interlocked.Add(ref _bytes, -bytes);
+                Interlocked.Add(ref _count, -count);
+            }
+
+            // For subsystems that are measured rather than counted as they go
+            public void Set(long bytes, long count) {
+                Interlocked.Exchange(ref _bytes, bytes);
+                Interlocked.Exchange(ref _count, count);
+                UpdatePeak(ref _peakBytes, bytes);
+                UpdatePeak(ref _peakCount, count);
+            }
+
+            private static void UpdatePeak(ref long peak, long value) {
+                long current = Interlocked.Read(ref peak);
+                while (value > current) {
+                    long previous = Interlocked.CompareExchange(ref peak, value, current);
+                    if (previous == current)
+                        break;
+                    current = previous;
+                }
+            }
+        }
+
+        private static List<Counter> Counters { get; } = new();
+
+        private static Counter AddCounter(string name, bool hasBytes = true, bool hasCount = true) {
+            Counter counter = new(name, hasBytes, hasCount);
+            Counters.Add(counter);
+            return counter;
+        }
+
+        internal static Counter InteropResults { get; } = AddCounter("Interop results");
+        internal static Counter GMLCallBuffers { get; } = AddCounter("GML call buffers");
+        internal static Counter AsyncCalls { get; } = AddCounter("Async calls", hasBytes: false);
+        internal static Counter SharedRegions { get; } = AddCounter("Shared regions");
+        internal static Counter LogData { get; } = AddCounter("Logger.LogData");
+        internal static Counter SettingsItems { get; } = AddCounter("Settings items", hasBytes: false);
+        internal static Counter FontAtlas { get; } = AddCounter("ImGui font atlas");
+        internal static Counter TraceSpans { get; } = AddCounter("Trace spans");
+        internal static Counter ManagedHeap { get; } = AddCounter("Managed heap", hasCount: false);
+
+        #region Interop results
+
+        // Timestamp is when the result was handed to gml, or 0 while C# still holds it
+        private readonly record struct OutstandingResult(long Bytes, string Owner, long Timestamp);
+
+        private static ConcurrentDictionary<IntPtr, OutstandingResult> OutstandingResults { get; } = new();
+
+        // Gml deletes a result in the same call, or as soon as it collects an async one, so anything older was most likely leaked
+        private const double LeakSeconds = 10;
+
+        internal static void TrackResult(IntPtr result, long bytes, string owner, bool handedToGML) {
+            OutstandingResults[result] = new(bytes, owner, handedToGML ? Stopwatch.GetTimestamp() : 0);
+            InteropResults.Add(bytes);
+        }
+
+        // Async results are only handed to gml once their call has completed, which is when gml can start collecting them
+        internal static void HandResultToGML(IntPtr result) {
+            if (OutstandingResults.TryGetValue(result, out OutstandingResult outstanding))
+                OutstandingResults.TryUpdate(result, outstanding with { Timestamp = Stopwatch.GetTimestamp() }, outstanding);
+        }
+
+        internal static void UntrackResult(IntPtr result) {
+            if (OutstandingResults.TryRemove(result, out OutstandingResult outstanding))
+                InteropResults.Remove(outstanding.Bytes);
+        }
+
+        private record struct Leak(string Owner, int Count, long Bytes, double OldestSeconds);
+
+        private static List<Leak> GetLeaks() {
+            long now = Stopwatch.GetTimestamp();
+            return OutstandingResults.Values
+                .Where(result => result.Timestamp != 0)
+                .Select(result => (result.Owner, result.Bytes, Seconds: (double)(now - result.Timestamp) / Stopwatch.Frequency))
+                .Where(result => result.Seconds >= LeakSeconds)
+                .GroupBy(result => result.Owner)
+                .Select(group => new Leak(group.Key, group.Count(), group.Sum(result => result.Bytes), group.Max(result => result.Seconds)))
+                .OrderByDescending(leak => leak.Bytes)
+                .ToList();
+        }
+
+        #endregion
+
+        #region Sampling
+
+        private const double SampleSeconds = 5;
+        private static long LastSample { get; set; } = 0;
+        private static HashSet<string> ReportedLeakOwners { get; } = new();
+
+        // Measures the subsystems that aren't counted as they go
+        private static void Sample() {
+            SettingsItems.Set(0, Settings.CountItems());
+            TraceSpans.Set(Tracing.GetStoredBytes(), Tracing.GetStoredCount());
+            ManagedHeap.Set(GC.GetGCMemoryInfo().HeapSizeBytes, 0);
+        }
+
+        /// <summary>
+        /// Samples every few seconds and warns about newly leaked results, called every frame from the overlay
+        /// </summary>
+        internal static void Update() {
+            long now = Stopwatch.GetTimestamp();
+            if (now - LastSample < SampleSeconds * Stopwatch.Frequency)
+                return;
+            LastSample = now;
+
+            Sample();
+            // Only sized from within an imgui frame
+            ImFontAtlasPtr fonts = ImGui.GetIO().Fonts;
+            FontAtlas.Set((long)fonts.TexWidth * fonts.TexHeight * 4, fonts.Fonts.Size);
+
+            bool hasNewLeak = false;
+            foreach (Leak leak in GetLeaks()) {
+                if (ReportedLeakOwners.Add(leak.Owner)) {
+                    Logger.WriteWarning($"{leak.Count} interop result(s) from {leak.Owner} ({leak.Bytes} bytes) have not been deleted for {leak.OldestSeconds:F0}s");
+                    hasNewLeak = true;
+                }
+            }
+            // So the dump shows the leak without anyone having to write it from the overlay
+            if (hasNewLeak)
+                WriteDump();
+        }
+
+        #endregion
+
+        #region Report
+
+        private const string DumpLocation = "SubModLoader/memory.json";
+        // The exit dump is written from another thread
+        private static readonly object DumpLock = new();
+        private static bool IsDumpingOnExit { get; set; } = false;
+
+        /// <summary>
+        /// Writes the dump now, and again when the process exits so it covers the whole session
+        /// </summary>
+        internal static void WriteDumpNowAndOnExit() {
+            WriteDump();
+            if (IsDumpingOnExit)
+                return;
+            IsDumpingOnExit = true;
+            AppDomain.CurrentDomain.ProcessExit += (_, _) => WriteDump();
+        }
+
+        /// <summary>
+        /// Writes every counter and outstanding leak as json
+        /// </summary>
+        internal static void WriteDump() {
+            lock (DumpLock)
+                WriteDumpLocked();
+        }
+
+        private static void WriteDumpLocked() {
+            try {
+                Sample();
+
+                using FileStream file = File.Create(DumpLocation);
+                using Utf8JsonWriter json = new(file, new() { Indented = true });
+
+                json.WriteStartObject();
+                json.WriteString("time", DateTime.Now);
+                json.WriteStartArray("subsystems");
+                foreach (Counter counter in Counters) {
+                    json.WriteStartObject();
+                    json.WriteString("name", counter.Name);
+                    if (counter.HasBytes) {
+                        json.WriteNumber("bytes", counter.Bytes);
+                        json.WriteNumber("peakBytes", counter.PeakBytes);
+                    }
+                    if (counter.HasCount) {
+                        json.WriteNumber("count", counter.Count);
+                        json.WriteNumber("peakCount", counter.PeakCount);
+                    }
+                    json.WriteEndObject();
+                }
+                json.WriteEndArray();
+
+                json.WriteStartArray("leaks");
+                foreach (Leak leak in GetLeaks()) {
+                    json.WriteStartObject();
+                    json.WriteString("owner", leak.Owner);
+                    json.WriteNumber("count", leak.Count);
+                    json.WriteNumber("bytes", leak.Bytes);
+                    json.WriteNumber("oldestSeconds", leak.OldestSeconds);
+                    json.WriteEndObject();
+                }
+                json.WriteEndArray();
+
+                json.WriteNumber("totalAllocatedBytes", GC.GetTotalAllocatedBytes());
+                json.WriteNumber("workingSetBytes", Environment.WorkingSet);
+                json.WriteEndObject();
+            } catch (Exception e) {
+                Logger.WriteWarning($"Could not write memory dump because: {e}");
+            }
+        }
+
+        private static SettingsCategory MemoryCategory { get; } = Settings.SubModLoaderSettings.GetCategory("Memory", false);
+        internal static SettingsBool IsMemoryWindowOpen { get; } = SettingsBool.Get(MemoryCategory, "IsMemoryWindowOpen", false);
+
+        private static string FormatBytes(long bytes) => $"{bytes / 1024.0:F1} KB";
+
+        internal static void ShowMemoryWindow() {
+            if (!IsMemoryWindowOpen.Value)
+                return;
+
+            ImGui.SetNextWindowSize(new Vector2(600, 400), ImGuiCond.FirstUseEver);
+            bool isOpen = IsMemoryWindowOpen.Value;
+            bool collapsed = !ImGui.Begin("Memory##SubModLoader", ref isOpen);
+            IsMemoryWindowOpen.Value = isOpen;
+            if (collapsed) {
+                ImGui.End();
+                return;
+            }
+
+            if (ImGui.BeginTable("Subsystems", 5, ImGuiTableFlags.SizingStretchProp | ImGuiTableFlags.RowBg | ImGuiTableFlags.BordersInnerV)) {
+                ImGui.TableSetupColumn("Subsystem");
+                ImGui.TableSetupColumn("Size");
+                ImGui.TableSetupColumn("Peak Size");
+                ImGui.TableSetupColumn("Count");
+                ImGui.TableSetupColumn("Peak Count");
+                ImGui.TableHeadersRow();
+
+                foreach (Counter counter in Counters) {
+                    ImGui.TableNextRow();
+                    ImGui.TableNextColumn();
+                    ImGui.TextUnformatted(counter.Name);
+                    ImGui.TableNextColumn();
+                    ImGui.TextUnformatted(counter.HasBytes ? FormatBytes(counter.Bytes) : "-");
+                    ImGui.TableNextColumn();
+                    ImGui.TextUnformatted(counter.HasBytes ? FormatBytes(counter.PeakBytes) : "-");
+                    ImGui.TableNextColumn();
+                    ImGui.TextUnformatted(counter.HasCount ? $"{counter.Count}" : "-");
+                    ImGui.TableNextColumn();
+                    ImGui.TextUnformatted(counter.HasCount ? $"{counter.PeakCount}" : "-");
+                }
+
+                ImGui.EndTable();
+            }
+
+            List<Leak> leaks = GetLeaks();
+            ImGui.Separator();
+            ImGui.TextUnformatted(leaks.Count == 0 ? "No leaked interop results" : $"Interop results not deleted for {LeakSeconds:F0}s or more:");
+            foreach (Leak leak in leaks)
+                ImGui.TextUnformatted($"{leak.Owner}: {leak.Count} result(s), {FormatBytes(leak.Bytes)}, oldest {leak.OldestSeconds:F0}s");
+
+            ImGui.Separator();
+            if (ImGui.Button($"Write {DumpLocation}"))
+                WriteDump();
+
+            ImGui.End();
+        }
+
+        #endregion
+    }
+}
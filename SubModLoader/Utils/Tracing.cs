@@ -0,0 +1,253 @@
+﻿using SubModLoader.Storage;
+using SubModLoader.Storage.Widget;
+using SubModLoader.Storage.Widget.Item;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Text.Json;
+
+namespace SubModLoader.Utils {
+    /// <summary>
+    /// Records timed spans into the same store as SubModLoaderNative, which are written out as a Chrome/Perfetto trace
+    /// </summary>
+    public static class Tracing {
+        /// <summary>
+        /// A span that is recorded once it is disposed
+        /// </summary>
+        public readonly struct Span : IDisposable {
+            private readonly string _category;
+            private readonly string _name;
+            private readonly long _start;
+            private readonly long _startAllocatedBytes;
+
+            internal Span(string category, string name) {
+                _category = category;
+                _name = name;
+                _startAllocatedBytes = GC.GetAllocatedBytesForCurrentThread();
+                _start = Stopwatch.GetTimestamp();
+            }
+
+            /// <summary>
+            /// Ends and records the span
+            /// </summary>
+            public void Dispose() {
+                if (_name is null)
+                    return;
+
+                long end = Stopwatch.GetTimestamp();
+                AddSpan(_category, _name, _start, end, GC.GetAllocatedBytesForCurrentThread() - _startAllocatedBytes);
+            }
+        }
+
+        internal const string SubModLoaderCategory = "SubModLoader";
+        internal const string NativeCategory = "Native";
+
+        /// <summary>
+        /// Starts a span, use with <see langword="using"/> so it ends at the end of the scope
+        /// </summary>
+        /// <param name="name">The name of the span</param>
+        /// <param name="category">The category of the span, mods should use their name</param>
+        /// <returns>The running span</returns>
+        public static Span Begin(string name, string category = SubModLoaderCategory) => new(category, name);
+
+        #region Native store
+
+        private const string NativeDll = "SubModLoaderNative.dll";
+
+        // Mirrors Tracing::Span in SubModLoaderNative/Tracing.h
+        [StructLayout(LayoutKind.Sequential)]
+        private unsafe struct NativeSpan {
+            public byte* Category;
+            public byte* Name;
+            public long Start;
+            public long End;
+            public long AllocatedBytes;
+            public uint ThreadId;
+        }
+
+        [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void TraceAddSpan([MarshalAs(UnmanagedType.LPUTF8Str)] string category, [MarshalAs(UnmanagedType.LPUTF8Str)] string name, long start, long end, long allocatedBytes);
+
+        [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TraceGetSpanCount();
+
+        [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        private static extern unsafe bool TraceGetSpan(int index, NativeSpan* span);
+
+        private record struct SpanRecord(string Category, string Name, long Start, long End, long AllocatedBytes, uint ThreadId) {
+            public double Milliseconds => (End - Start) * 1000.0 / Stopwatch.Frequency;
+        }
+
+        // SubModLoaderNative isn't there when running outside of the game, such as from SubModLoaderCLI
+        private static bool UseNativeStore { get; set; } = true;
+        private static List<SpanRecord> ManagedSpans { get; } = new();
+
+        private static void AddSpan(string category, string name, long start, long end, long allocatedBytes) {
+            if (UseNativeStore) {
+                try {
+                    TraceAddSpan(category, name, start, end, allocatedBytes);
+                    return;
+                } catch (Exception e) when (e is DllNotFoundException or EntryPointNotFoundException) {
+                    UseNativeStore = false;
+                }
+            }
+
+            lock (ManagedSpans)
+                ManagedSpans.Add(new(category, name, start, end, allocatedBytes, (uint)Environment.CurrentManagedThreadId));
+        }
+
+        private static unsafe List<SpanRecord> GetSpans() {
+            if (!UseNativeStore) {
+                lock (ManagedSpans)
+                    return new(ManagedSpans);
+            }
+
+            List<SpanRecord> spans = new();
+
+            int count = TraceGetSpanCount();
+            for (int i = 0; i < count; i++) {
+                NativeSpan span;
+                if (!TraceGetSpan(i, &span))
+                    break;
+                spans.Add(new(Marshal.PtrToStringUTF8((IntPtr)span.Category), Marshal.PtrToStringUTF8((IntPtr)span.Name), span.Start, span.End, span.AllocatedBytes, span.ThreadId));
+            }
+
+            return spans;
+        }
+
+        internal static int GetStoredCount() {
+            if (UseNativeStore) {
+                try {
+                    return TraceGetSpanCount();
+                } catch (Exception e) when (e is DllNotFoundException or EntryPointNotFoundException) {
+                    UseNativeStore = false;
+                }
+            }
+
+            lock (ManagedSpans)
+                return ManagedSpans.Count;
+        }
+
+        // Not counting the interned names, which are shared between spans
+        internal static unsafe long GetStoredBytes() => (long)GetStoredCount() * (UseNativeStore ? sizeof(NativeSpan) : Unsafe.SizeOf<SpanRecord>());
+
+        #endregion
+
+        #region Report
+
+        private const string TraceLocation = "SubModLoader/trace.json";
+        // Warn when startup is this much slower than the previous launch
+        private const double RegressionThreshold = 1.25;
+
+        /// <summary>
+        /// Writes the trace file and a summary of the recorded spans to the log
+        /// </summary>
+        /// <param name="mode">How startup went, each mode is only compared against its own previous launch</param>
+        internal static void WriteReport(string mode) {
+            try {
+                List<SpanRecord> spans = GetSpans();
+                if (spans.Count == 0)
+                    return;
+
+                // Sort parents before their children so nesting can be found with a stack per thread
+                spans.Sort((a, b) => a.ThreadId != b.ThreadId ? a.ThreadId.CompareTo(b.ThreadId) : a.Start != b.Start ? a.Start.CompareTo(b.Start) : b.End.CompareTo(a.End));
+
+                WriteTrace(spans);
+                WriteSummary(spans, mode);
+            } catch (Exception e) {
+                Logger.WriteWarning($"Could not write startup trace because: {e}");
+            }
+        }
+
+        private static void WriteTrace(List<SpanRecord> spans) {
+            long origin = spans.Min(span => span.Start);
+            double ticksToMicroseconds = 1_000_000.0 / Stopwatch.Frequency;
+            int processId = Environment.ProcessId;
+
+            using FileStream file = File.Create(TraceLocation);
+            using Utf8JsonWriter json = new(file);
+
+            json.WriteStartObject();
+            json.WriteString("displayTimeUnit", "ms");
+            json.WriteStartArray("traceEvents");
+            foreach (SpanRecord span in spans) {
+                json.WriteStartObject();
+                json.WriteString("name", span.Name);
+                json.WriteString("cat", span.Category);
+                json.WriteString("ph", "X");
+                json.WriteNumber("ts", (span.Start - origin) * ticksToMicroseconds);
+                json.WriteNumber("dur", (span.End - span.Start) * ticksToMicroseconds);
+                json.WriteNumber("pid", processId);
+                json.WriteNumber("tid", span.ThreadId);
+                if (span.AllocatedBytes >= 0) {
+                    json.WriteStartObject("args");
+                    json.WriteNumber("allocatedBytes", span.AllocatedBytes);
+                    json.WriteEndObject();
+                }
+                json.WriteEndObject();
+            }
+            json.WriteEndArray();
+            json.WriteEndObject();
+        }
+
+        private static string FormatAllocated(long bytes) => bytes < 0 ? "-" : $"{bytes / 1024.0:F1}";
+
+        private static void WriteSummary(List<SpanRecord> spans, string mode) {
+            Dictionary<string, (double milliseconds, long allocatedBytes)> categoryTotals = new();
+            double totalMilliseconds = 0;
+
+            Logger.DrawLine();
+            Logger.WriteLine($"Startup trace written to {TraceLocation}");
+            Logger.WriteLine($"{"Span",-50} {"Time (ms)",12} {"Alloc (KB)",12}");
+
+            Stack<SpanRecord> parents = new();
+            uint threadId = 0;
+            foreach (SpanRecord span in spans) {
+                if (span.ThreadId != threadId) {
+                    parents.Clear();
+                    threadId = span.ThreadId;
+                }
+                while (parents.Count > 0 && parents.Peek().End <= span.Start)
+                    parents.Pop();
+
+                if (parents.Count == 0)
+                    totalMilliseconds += span.Milliseconds;
+
+                // Only count the outermost span of a category so nested spans aren't counted twice
+                if (span.Category != SubModLoaderCategory && span.Category != NativeCategory && !parents.Any(parent => parent.Category == span.Category)) {
+                    categoryTotals.TryGetValue(span.Category, out (double milliseconds, long allocatedBytes) total);
+                    categoryTotals[span.Category] = (total.milliseconds + span.Milliseconds, total.allocatedBytes + Math.Max(span.AllocatedBytes, 0));
+                }
+
+                string name = $"{new string(' ', parents.Count * 2)}{span.Category}/{span.Name}";
+                Logger.WriteLine($"{name,-50} {span.Milliseconds,12:F2} {FormatAllocated(span.AllocatedBytes),12}");
+
+                parents.Push(span);
+            }
+
+            if (categoryTotals.Count > 0) {
+                Logger.WriteLine($"{"Mod",-50} {"Time (ms)",12} {"Alloc (KB)",12}");
+                foreach ((string category, (double milliseconds, long allocatedBytes)) in categoryTotals.OrderByDescending(kvp => kvp.Value.milliseconds))
+                    Logger.WriteLine($"{category,-50} {milliseconds,12:F2} {FormatAllocated(allocatedBytes),12}");
+            }
+
+            Logger.WriteLine($"{"Total",-50} {totalMilliseconds,12:F2}");
+
+            SettingsCategory tracingCategory = Settings.SubModLoaderSettings.GetCategory("Tracing", false);
+            SettingsFloat<double> lastTotal = SettingsFloat<double>.Get(tracingCategory, $"Last{mode}StartupMilliseconds", 0);
+            if (lastTotal.Value > 0 && totalMilliseconds > lastTotal.Value * RegressionThreshold)
+                Logger.WriteWarning($"{mode} startup took {totalMilliseconds:F2}ms, up from {lastTotal.Value:F2}ms last time");
+            lastTotal.Value = totalMilliseconds;
+
+            Logger.DrawLine();
+            Logger.DrawSpacer();
+        }
+
+        #endregion
+    }
+}
@@ -0,0 +1,133 @@
+﻿using SubModLoader.Mods;
+using SubModLoader.Storage;
+using SubModLoader.Utils;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Threading.Tasks;
+
+namespace SubModLoaderCLI {
+    internal static class Program {
+        private const string Usage = """
+            Builds modded.win outside of the game, the game then uses it for as long as data.win and the mods haven't changed.
+
+            Usage: SubModLoaderCLI [--parallel <count>] <data.win> <mods folder> <modded.win> [<data.win> <mods folder> <modded.win> ...]
+
+            The folder of each modded.win is treated as the game folder, so settings are read from and log.txt and trace.json are written to its SubModLoader folder.
+            Each build needs its own folder.
+            """;
+
+        private sealed record Job(string DataWin, string ModsDirectory, string ModdedWin) {
+            public string GameDirectory => Path.GetDirectoryName(ModdedWin);
+        }
+
+        private static int Main(string[] args) {
+            int parallel = Environment.ProcessorCount;
+            List<string> paths = new();
+
+            for (int i = 0; i < args.Length; i++) {
+                if (args[i] is "-h" or "--help") {
+                    Console.WriteLine(Usage);
+                    return 0;
+                } else if (args[i] is "-j" or "--parallel") {
+                    if (i + 1 >= args.Length || !int.TryParse(args[++i], out parallel) || parallel < 1) {
+                        Console.Error.WriteLine(Usage);
+                        return 1;
+                    }
+                } else
+                    paths.Add(Path.GetFullPath(args[i]));
+            }
+
+            if (paths.Count == 0 || paths.Count % 3 != 0) {
+                Console.Error.WriteLine(Usage);
+                return 1;
+            }
+
+            List<Job> jobs = paths.Chunk(3).Select(job => new Job(job[0], job[1], job[2])).ToList();
+            if (jobs.DistinctBy(job => job.GameDirectory).Count() != jobs.Count) {
+                Console.Error.WriteLine("Each modded.win needs its own folder.");
+                return 1;
+            }
+
+            return jobs.Count == 1 ? Build(jobs[0]) : BuildAll(jobs, parallel);
+        }
+
+        // SubModLoader keeps its state in static classes, so a process can only do one build
+        private static int Build(Job job) {
+            Directory.CreateDirectory(Path.Combine(job.GameDirectory, "SubModLoader"));
+            Directory.SetCurrentDirectory(job.GameDirectory);
+
+            try {
+                // Modding's static settings are created on first use, which needs the settings loaded first
+                using (Tracing.Begin("Settings.Load"))
+                    Settings.Load();
+
+                Modding.UnModdedDataPath = job.DataWin;
+                Modding.OriginalDataPath = job.DataWin;
+                Modding.ModsDirectory = job.ModsDirectory;
+                Modding.ModdedDataPath = job.ModdedWin;
+
+                SubModLoader.SubModLoader.BuildModdedData();
+
+                Tracing.WriteReport("CLI");
+                MemoryTracker.WriteDump();
+            } catch (Exception e) {
+                Logger.WriteError(e);
+                return 1;
+            }
+
+            return 0;
+        }
+
+        // Runs each build in its own process of this program, then reports how long each one took
+        private static int BuildAll(List<Job> jobs, int parallel) {
+            string[] command = GetCommand();
+            (int exitCode, TimeSpan time)[] results = new (int, TimeSpan)[jobs.Count];
+            object outputLock = new();
+
+            Parallel.For(0, jobs.Count, new ParallelOptions { MaxDegreeOfParallelism = parallel }, i => {
+                Job job = jobs[i];
+
+                ProcessStartInfo startInfo = new(command[0]) {
+                    RedirectStandardOutput = true,
+                    RedirectStandardError = true
+                };
+                foreach (string arg in command.Skip(1).Append(job.DataWin).Append(job.ModsDirectory).Append(job.ModdedWin))
+                    startInfo.ArgumentList.Add(arg);
+
+                Stopwatch time = Stopwatch.StartNew();
+                using Process process = Process.Start(startInfo);
+                Task<string> error = process.StandardError.ReadToEndAsync();
+                string output = process.StandardOutput.ReadToEnd();
+                process.WaitForExit();
+                time.Stop();
+
+                // Print each build's output in one piece rather than interleaved
+                lock (outputLock) {
+                    Console.WriteLine($"==== {job.ModdedWin} ====");
+                    Console.Write(output);
+                    Console.Error.Write(error.Result);
+                    Console.WriteLine();
+                }
+
+                results[i] = (process.ExitCode, time.Elapsed);
+            });
+
+            Console.WriteLine($"{"modded.win",-70} {"Result",8} {"Time (s)",10}");
+            for (int i = 0; i < jobs.Count; i++)
+                Console.WriteLine($"{jobs[i].ModdedWin,-70} {(results[i].exitCode == 0 ? "OK" : "FAILED"),8} {results[i].time.TotalSeconds,10:F2}");
+
+            return results.All(result => result.exitCode == 0) ? 0 : 1;
+        }
+
+        private static string[] GetCommand() {
+            string processPath = Environment.ProcessPath;
+            // Started with "dotnet SubModLoaderCLI.dll" rather than the apphost
+            if (Path.GetFileNameWithoutExtension(processPath) == "dotnet")
+                return new[] { processPath, typeof(Program).Assembly.Location };
+            return new[] { processPath };
+        }
+    }
+}
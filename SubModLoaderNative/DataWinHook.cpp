@@ -4,8 +4,10 @@
 #include "detours/detours.h"
 #include "DataWinHook.h"
 #include "NetBootstrap.h"
+#include "Tracing.h"
 
 using namespace std;
+using namespace SubModLoader::Utils;
 
 namespace Bootstrap {
     HANDLE(__stdcall* TrueCreateFileW)(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile) = CreateFileW;
@@ -19,8 +21,15 @@ namespace Bootstrap {
             if (!hasGenerated) {
                 hasGenerated = true;
 
-                if (!RunSubModLoader())
-                    failedGenerating = true;
+                {
+                    Tracing::ScopedSpan span("Native", "FakeCreateFileW");
+                    if (!RunSubModLoader())
+                        failedGenerating = true;
+                }
+
+                // Only once the span above has closed, so the report includes it
+                if (!failedGenerating)
+                    WriteStartupReport();
             }
 
             if (!failedGenerating)
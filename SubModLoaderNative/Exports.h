@@ -2,3 +2,4 @@
 
 #define GAMEMAKEREXPORT extern "C" __declspec(dllexport)
 #define IMGUIEXPORT GAMEMAKEREXPORT
+#define CSHARPEXPORT GAMEMAKEREXPORT
@@ -7,6 +7,10 @@ using namespace std;
 using namespace SubModLoader::GMLInterop;
 
 GMLInteropManager::CallCSharpFunc GMLInteropManager::CallCSharp = nullptr;
+GMLInteropManager::CallCSharpAsyncFunc GMLInteropManager::CallCSharpAsync = nullptr;
+GMLInteropManager::PollCSharpAsyncFunc GMLInteropManager::PollCSharpAsync = nullptr;
+GMLInteropManager::CollectCSharpAsyncFunc GMLInteropManager::CollectCSharpAsync = nullptr;
+GMLInteropManager::CancelCSharpAsyncFunc GMLInteropManager::CancelCSharpAsync = nullptr;
 GMLInteropWriter::DeleteBytesFunc GMLInteropWriter::DeleteBytes = nullptr;
 
 GAMEMAKEREXPORT void CallCSharp(void* metadata, void* argData, void** resultData) {
@@ -15,8 +19,33 @@ GAMEMAKEREXPORT void CallCSharp(void* metadata, void* argData, void** resultData
 	GMLInteropManager::CallCSharp(metadata, argData, resultData);
 }
 
+// Handles are doubles in gml, they stay exact up to 2^53
+GAMEMAKEREXPORT double CallCSharpAsync(void* metadata, void* argData) {
+	if (GMLInteropManager::CallCSharpAsync == nullptr)
+		return 0;
+	return (double)GMLInteropManager::CallCSharpAsync(metadata, argData);
+}
+
+GAMEMAKEREXPORT double PollCSharpAsync(double handle) {
+	if (GMLInteropManager::PollCSharpAsync == nullptr)
+		return -1;
+	return GMLInteropManager::PollCSharpAsync((int64_t)handle);
+}
+
+GAMEMAKEREXPORT double CollectCSharpAsync(double handle, void** resultData) {
+	if (GMLInteropManager::CollectCSharpAsync == nullptr)
+		return -1;
+	return GMLInteropManager::CollectCSharpAsync((int64_t)handle, resultData);
+}
+
+GAMEMAKEREXPORT void CancelCSharpAsync(double handle) {
+	if (GMLInteropManager::CancelCSharpAsync == nullptr)
+		return;
+	GMLInteropManager::CancelCSharpAsync((int64_t)handle);
+}
+
 GAMEMAKEREXPORT void DeleteResult(void** resultData) {
-	if (GMLInteropWriter::DeleteBytes == nullptr)
+	if (GMLInteropWriter::DeleteBytes == nullptr || *resultData == nullptr)
 		return;
 	GMLInteropWriter::DeleteBytes(*resultData);
 }
@@ -25,11 +54,16 @@ inline uint32_t GetSize(void* buffer) {
 	return ((uint32_t*)buffer)[0];
 }
 
+// The result is null when the call threw
 GAMEMAKEREXPORT double GetResultSize(void** resultData) {
+	if (*resultData == nullptr)
+		return 0;
 	return GetSize(*resultData);
 }
 
 GAMEMAKEREXPORT void CopyResultToBuffer(void* buffer, void** resultData) {
+	if (*resultData == nullptr)
+		return;
 	uint32_t size = GetSize(*resultData);
 	memcpy_s(buffer, size, *resultData, size);
 }
\ No newline at end of file
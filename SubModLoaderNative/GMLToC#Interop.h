@@ -1,10 +1,19 @@
 #pragma once
+#include <cstdint>
 
 namespace SubModLoader::GMLInterop {
 	namespace GMLInteropManager {
 		typedef void(__stdcall* CallCSharpFunc)(void* metadata, void* argData, void** resultData);
+		typedef int64_t(__stdcall* CallCSharpAsyncFunc)(void* metadata, void* argData);
+		typedef int32_t(__stdcall* PollCSharpAsyncFunc)(int64_t handle);
+		typedef int32_t(__stdcall* CollectCSharpAsyncFunc)(int64_t handle, void** resultData);
+		typedef void(__stdcall* CancelCSharpAsyncFunc)(int64_t handle);
 
 		extern CallCSharpFunc CallCSharp;
+		extern CallCSharpAsyncFunc CallCSharpAsync;
+		extern PollCSharpAsyncFunc PollCSharpAsync;
+		extern CollectCSharpAsyncFunc CollectCSharpAsync;
+		extern CancelCSharpAsyncFunc CancelCSharpAsync;
 	}
 
 	namespace GMLInteropWriter {
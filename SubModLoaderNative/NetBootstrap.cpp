@@ -4,6 +4,7 @@
 #include "GMLToC#Interop.h"
 #include "ImGUIHooks.h"
 #include "NetBootstrap.h"
+#include "Tracing.h"
 
 #include "nethost.h"
 #include "hostfxr.h"
@@ -11,6 +12,7 @@
 
 using namespace std;
 using namespace SubModLoader;
+using namespace SubModLoader::Utils;
 
 namespace Bootstrap {
 
@@ -69,6 +71,8 @@ namespace Bootstrap {
 
     typedef bool(__stdcall* entryPointDelegate)();
     entryPointDelegate EntryPoint = nullptr;
+    typedef void(__stdcall* writeStartupReportDelegate)();
+    writeStartupReportDelegate StartupReport = nullptr;
 
     constexpr const char_t subModLoaderRuntimeConfig[] = L"SubModloader/SubModLoader.runtimeconfig.json";
     constexpr const char_t subModLoaderAssembly[] = L"SubModLoader/SubModLoader.dll";
@@ -86,6 +90,8 @@ namespace Bootstrap {
     }
 
     bool LoadSubModLoader() {
+        Tracing::ScopedSpan span("Native", "LoadSubModLoader");
+
         if (!LoadHostfxr())
             return false;
 
@@ -98,9 +104,24 @@ namespace Bootstrap {
         if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.SubModLoader", L"EntryPoint", (void**)&EntryPoint))
             return false;
 
+        if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.SubModLoader", L"WriteStartupReport", (void**)&StartupReport))
+            return false;
+
         if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropManager", L"CallCSharp", (void**)&GMLInterop::GMLInteropManager::CallCSharp))
             return false;
 
+        if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropManager", L"CallCSharpAsync", (void**)&GMLInterop::GMLInteropManager::CallCSharpAsync))
+            return false;
+
+        if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropManager", L"PollCSharpAsync", (void**)&GMLInterop::GMLInteropManager::PollCSharpAsync))
+            return false;
+
+        if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropManager", L"CollectCSharpAsync", (void**)&GMLInterop::GMLInteropManager::CollectCSharpAsync))
+            return false;
+
+        if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropManager", L"CancelCSharpAsync", (void**)&GMLInterop::GMLInteropManager::CancelCSharpAsync))
+            return false;
+
         if (!LoadDotNetFunc(dotNetLoadAssembly, L"SubModLoader.GMLInterop.GMLInteropWriter", L"DeleteBytes", (void**)&GMLInterop::GMLInteropWriter::DeleteBytes))
             return false;
 
@@ -146,4 +167,9 @@ namespace Bootstrap {
             return EntryPoint();
         return false;
     }
+
+    void WriteStartupReport() {
+        if (StartupReport != nullptr)
+            StartupReport();
+    }
 }
\ No newline at end of file
@@ -3,4 +3,5 @@
 namespace Bootstrap {
 	bool RunSubModLoader();
 	bool LoadSubModLoader();
+	void WriteStartupReport();
 }
@@ -0,0 +1,78 @@
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Exports.h"
+#include "SharedState.h"
+
+using namespace std;
+using namespace SubModLoader::GMLInterop;
+
+namespace SubModLoader::GMLInterop::SharedState {
+    mutex regionsMutex;
+    // Regions are never freed so the pointers handed out to C# stay valid
+    vector<unique_ptr<Region>> regions;
+    unordered_map<string, size_t> regionIndices;
+
+    Region* GetRegion(const char* name) {
+        lock_guard lock(regionsMutex);
+        auto index = regionIndices.find(name);
+        return index == regionIndices.end() ? nullptr : regions[index->second].get();
+    }
+
+    Region* GetRegion(double index) {
+        lock_guard lock(regionsMutex);
+        if (index < 0 || index >= (double)regions.size())
+            return nullptr;
+        return regions[(size_t)index].get();
+    }
+}
+
+// The buffers are gml buffers since gml can't wrap memory it didn't allocate, they must be buffer_fixed so they never move
+GAMEMAKEREXPORT double SharedStateRegister(const char* name, uint8_t* buffer0, uint8_t* buffer1, double size) {
+    lock_guard lock(SharedState::regionsMutex);
+
+    auto index = SharedState::regionIndices.find(name);
+    if (index == SharedState::regionIndices.end()) {
+        index = SharedState::regionIndices.emplace(name, SharedState::regions.size()).first;
+        SharedState::regions.push_back(make_unique<SharedState::Region>());
+    }
+
+    SharedState::Region* region = SharedState::regions[index->second].get();
+    region->counts[0] = region->counts[1] = 0;
+    region->size = (uint32_t)size;
+    region->buffers[0] = buffer0;
+    region->buffers[1] = buffer1;
+    // The gml init always starts with buffer0 in front, so move on to the next even sequence, which also makes any snapshot of the old buffers read as stale when registered again
+    InterlockedExchange64(&region->sequence, (region->sequence + 2) & ~1LL);
+
+    return (double)index->second;
+}
+
+GAMEMAKEREXPORT double SharedStatePublish(double index, double count) {
+    SharedState::Region* region = SharedState::GetRegion(index);
+    if (region == nullptr)
+        return -1;
+    region->counts[(region->sequence + 1) & 1] = (uint32_t)count;
+    return (double)InterlockedIncrement64(&region->sequence);
+}
+
+GAMEMAKEREXPORT double SharedStateGetSequence(double index) {
+    SharedState::Region* region = SharedState::GetRegion(index);
+    if (region == nullptr)
+        return -1;
+    return (double)InterlockedCompareExchange64(&region->sequence, 0, 0);
+}
+
+GAMEMAKEREXPORT double SharedStateGetCount(double index, double sequence) {
+    SharedState::Region* region = SharedState::GetRegion(index);
+    if (region == nullptr)
+        return 0;
+    return region->counts[(int64_t)sequence & 1];
+}
+
+CSHARPEXPORT SharedState::Region* SharedStateGetRegion(const char* name) {
+    return SharedState::GetRegion(name);
+}
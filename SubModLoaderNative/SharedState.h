@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace SubModLoader::GMLInterop::SharedState {
+    // Mirrored in SubModLoader/GMLInterop/GMLSharedRegion.cs, keep the layouts the same
+    // The front buffer is buffers[sequence & 1], the writer fills the other one then publishes by incrementing sequence
+    struct Region {
+        volatile int64_t sequence;
+        uint32_t counts[2];
+        uint32_t size;
+        uint8_t* buffers[2];
+    };
+
+    Region* GetRegion(const char* name);
+}
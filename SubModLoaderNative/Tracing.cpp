@@ -0,0 +1,51 @@
+#include <windows.h>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Exports.h"
+#include "Tracing.h"
+
+using namespace std;
+using namespace SubModLoader::Utils;
+
+namespace SubModLoader::Utils::Tracing {
+    mutex spansMutex;
+    vector<Span> spans;
+    // node based so the c_str pointers handed out in spans stay valid
+    unordered_set<string> names;
+
+    int64_t Now() {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+    }
+
+    const char* Intern(const char* name) {
+        return names.emplace(name == nullptr ? "" : name).first->c_str();
+    }
+
+    void AddSpan(const char* category, const char* name, int64_t start, int64_t end, int64_t allocatedBytes) {
+        DWORD threadId = GetCurrentThreadId();
+
+        lock_guard lock(spansMutex);
+        spans.push_back({ Intern(category), Intern(name), start, end, allocatedBytes, threadId });
+    }
+}
+
+CSHARPEXPORT void TraceAddSpan(const char* category, const char* name, int64_t start, int64_t end, int64_t allocatedBytes) {
+    Tracing::AddSpan(category, name, start, end, allocatedBytes);
+}
+
+CSHARPEXPORT int32_t TraceGetSpanCount() {
+    lock_guard lock(Tracing::spansMutex);
+    return (int32_t)Tracing::spans.size();
+}
+
+CSHARPEXPORT bool TraceGetSpan(int32_t index, Tracing::Span* span) {
+    lock_guard lock(Tracing::spansMutex);
+    if (index < 0 || index >= (int32_t)Tracing::spans.size())
+        return false;
+    *span = Tracing::spans[index];
+    return true;
+}
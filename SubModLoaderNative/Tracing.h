@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+namespace SubModLoader::Utils::Tracing {
+    // Mirrored in SubModLoader/Utils/Tracing.cs, keep the layouts the same
+    struct Span {
+        const char* category;
+        const char* name;
+        int64_t start;
+        int64_t end;
+        int64_t allocatedBytes;
+        uint32_t threadId;
+    };
+
+    // QueryPerformanceCounter ticks, the same clock as System.Diagnostics.Stopwatch
+    int64_t Now();
+    void AddSpan(const char* category, const char* name, int64_t start, int64_t end, int64_t allocatedBytes = -1);
+
+    class ScopedSpan {
+    public:
+        ScopedSpan(const char* category, const char* name) : category(category), name(name), start(Now()) { }
+        ~ScopedSpan() { AddSpan(category, name, start, Now()); }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+        const char* category;
+        const char* name;
+        int64_t start;
+    };
+}
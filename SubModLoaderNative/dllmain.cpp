@@ -2,10 +2,15 @@
 #include "DataWinHook.h"
 #include "ImGUIHooks.h"
 #include "NetBootstrap.h"
+#include "Tracing.h"
+
+using namespace SubModLoader::Utils;
 
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReserved) {
     switch (ul_reason_for_call) {
         case DLL_PROCESS_ATTACH: {
+            Tracing::ScopedSpan span("Native", "DllMain");
+
             if (Bootstrap::LoadSubModLoader()) {
                 Bootstrap::AttachDataWinHook();
                 Bootstrap::AttachImGuiHooks();
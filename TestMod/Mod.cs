@@ -1,5 +1,8 @@
 ﻿using SubmachineModLib;
+using SubmachineModLib.Models;
 using SubModLoader.GameData.Extensions;
+using SubModLoader.GMLInterop;
+using SubModLoader.GMLInterop.Enums;
 using SubModLoader.Mods;
 using SubModLoader.Mods.Attributes;
 using SubModLoader.Storage.Widget;
@@ -7,9 +10,12 @@ using SubModLoader.Storage.Widget.Item;
 using SubModLoader.Utils;
 using System;
 using System.Runtime.InteropServices;
+using System.Threading;
+using System.Threading.Tasks;
 
 [assembly: SubModInfo<TestMod.Mod>("Test Mod", "0.0.0", "X.Core")]
 [assembly: SubModColor(0xFF, 0x45, 0x00)]
+[assembly: SubModRebuildsRegistry]
 
 namespace TestMod {
     public sealed class Mod : SubMod {
@@ -55,9 +61,77 @@ namespace TestMod {
 
         public static int[] IntArray(int[] ints) => ints;
 
+        [StructLayout(LayoutKind.Sequential)]
+        public struct SharedTest {
+            public int Int;
+            public float Float;
+            public bool Bool;
+        }
+
+        public static int SharedSum() {
+            if (!GMLInteropManager.GetSharedRegion<SharedTest>("testmod_shared").TryRead(out GMLSharedRegion<SharedTest>.Snapshot snapshot))
+                return -1;
+
+            int sum = 0;
+            foreach (SharedTest test in snapshot.Elements)
+                sum += test.Bool ? test.Int : 0;
+            return sum;
+        }
+
+        public static async Task<int> SumAsync(int a, int b) {
+            await Task.Delay(100);
+            return a + b;
+        }
+
+        public static async Task<string> WaitForCancel(string message, CancellationToken cancellation) {
+            await Task.Delay(Timeout.Infinite, cancellation);
+            return message;
+        }
+
+        private const string Object_async_test = "o_testmod_async_test";
+
+        // Async results only reach gml on later frames, so they're polled from the step event of an object placed in the first room
+        private void AddAsyncTest(GameMakerData gameData) {
+            if (IsGeneratingGML) {
+                GameMakerGameObject gameObject = new() {
+                    Name = gameData.Strings.MakeString(Object_async_test),
+                    Visible = false
+                };
+                gameData.GameObjects.Add(gameObject);
+
+                GameMakerRoom.GameObject roomGameObject = new() { InstanceID = gameData.GeneralInfo.LastObj++, ObjectDefinition = gameObject };
+
+                if (gameData.IsGameMaker2()) {
+                    GameMakerRoom.Layer layer = gameData.Rooms[0].AddLayer<GameMakerRoom.Layer.LayerInstancesData>(gameData, "testmod_async_test_layer");
+                    layer.InstancesData.Instances.Add(roomGameObject);
+                }
+
+                gameData.Rooms[0].GameObjects.Add(roomGameObject);
+            }
+
+            gameData.AddCode($"gml_Object_{Object_async_test}_Create_0", $$"""
+                sum_handle = {{CallFromGMLAsync(SumAsync, "1", "2")}}
+                wait_handle = {{CallFromGMLAsync(WaitForCancel, "\"cancelled\"")}}
+                finished = false
+                """);
+            gameData.AddCode($"gml_Object_{Object_async_test}_Step_0", $$"""
+                if (!finished && {{AsyncStatusFromGML("sum_handle")}} != {{(int)GMLInteropAsyncStatus.Pending}}) {
+                    finished = true
+                    {{Logger.WriteLineFromGML(AsyncResultFromGML("sum_handle"))}}
+                    // Only returns once cancelled, so this is still pending
+                    {{Logger.WriteLineFromGML(AsyncStatusFromGML("wait_handle"))}}
+                    {{AsyncCancelFromGML("wait_handle")}}
+                    // Cancelling frees the handle, so this is invalid
+                    {{Logger.WriteLineFromGML(AsyncStatusFromGML("wait_handle"))}}
+                }
+                """);
+        }
+
         public override void ApplyMod(GameMakerData gameData) {
             Logger.WriteLine("Applying mod...");
 
+            GMLSharedRegion shared = GMLInteropManager.RegisterSharedRegion<SharedTest>(gameData, "testmod_shared", 4, GMLSharedRegionWriter.GML).Region;
+
             AddOnGMLInitialize(gameData.AddCodeAndFunction("test_func", $$"""
                 {{Logger.WriteLineFromGML(CallFromGML(Byte, $"{byte.MaxValue}"))}}
                 {{Logger.WriteLineFromGML(CallFromGML(SByte, $"{sbyte.MinValue}"))}}
@@ -84,8 +158,15 @@ namespace TestMod {
                 array_set(a, 2, 2)
                 array_set(a, 3, 5)
                 {{Logger.WriteLineFromGML(CallFromGML(IntArray, "a"))}}
+                {{shared.GMLSet}}(0, 1, 0.5, true)
+                {{shared.GMLSet}}(1, 2, 1.5, false)
+                {{shared.GMLSet}}(2, 4, 2.5, true)
+                {{shared.GMLPublish}}(3)
+                {{Logger.WriteLineFromGML(CallFromGML(SharedSum))}}
                 """).function);
 
+            AddAsyncTest(gameData);
+
             Logger.WriteLine("█▇▆▅▄▃▂▁ 🤯");
             Logger.WriteLine("  ", backgroundColor: Color.ConsoleBlack);
             Logger.WriteLine("  ", backgroundColor: Color.ConsoleRed);